@@ -4,18 +4,63 @@
 #include <string.h>
 
 #include <cstddef>
+#include <memory>
 #include <algorithm>
 #include <functional>
 
+#include "common/comm_def.h"
+#include "net/buffer_pool.h"
+
 namespace dy
 {
 namespace utility
 {
+/**
+ * @brief 数据包视图, 持有底层内存的引用计数, 可跨线程保留而无需拷贝
+ */
+class packet_view
+{
+public:
+    using size_type = std::size_t;
+    using holder_type = std::shared_ptr<const void>;
+
+    packet_view() = default;
+
+    packet_view(holder_type holder, const char* data, const size_type& size)
+        : holder_(std::move(holder)), data_(data), size_(size)
+    {
+    }
+
+    const char* data() const
+    {
+        return data_;
+    }
+
+    const size_type& size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    const holder_type& holder() const
+    {
+        return holder_;
+    }
+
+private:
+    holder_type holder_;        // 内存引用
+    const char* data_{nullptr}; // 数据地址
+    size_type size_{0};         // 数据长度
+};
+
 class buffer
 {
 public:
-    using buff_type = std::string;
-    using size_type = buff_type::size_type;
+    using size_type = std::size_t;
 
     enum constant : size_type
     {
@@ -24,29 +69,31 @@ public:
         per_alloc_size = 32 * 1024,         // 32K
     };
 
+    DISABLE_COPY_ASSIGN(buffer);
+
     buffer()
     {
-        container_.resize(constant::initial_size);
+        allocate(constant::initial_size);
         size_ = 0;
         offset_ = 0;
     }
 
     buffer(const char* data, const size_type& length)
     {
-        container_.resize(constant::initial_size > length ? constant::initial_size : length);
-        memcpy(const_cast<char*>(container_.data()), data, length);
+        allocate(constant::initial_size > length ? constant::initial_size : length);
+        memcpy(storage_, data, length);
         size_ = length;
         offset_ = 0;
     }
 
     virtual ~buffer()
     {
-        // nothing
+        // slab_析构时归还内存
     }
 
     const char* data() const
     {
-        return container_.data() + offset_;
+        return storage_ + offset_;
     }
 
     const size_type& size() const
@@ -62,69 +109,182 @@ public:
     void push_cache(const size_type& size)
     {
         size_ += size;
+        high_water_ = std::max(high_water_, size_);
     }
 
     void pop_cache(const size_type& size)
     {
         offset_ += size;
         size_ -= size;
+        // 预留提示针对的数据包已取走
+        reserve_ = 0;
     }
 
     void clear()
     {
         offset_ = 0;
         size_ = 0;
+        reserve_ = 0;
+    }
+
+    size_type capacity() const
+    {
+        return capacity_;
+    }
+
+    const size_type& high_water() const
+    {
+        return high_water_;
+    }
+
+    /**
+     * @brief 保留当前位置起size字节的视图, 与缓存共享内存不拷贝
+     * 视图存在期间缓存不会在原内存上整理数据, 需要整理时改用新内存
+     */
+    packet_view retain(const size_type& size) const
+    {
+        return packet_view(slab_, data(), size);
+    }
+
+    /**
+     * @brief 预留提示, 解包方法读到包头长度后调用, 下次写入前一次性扩容到可容纳整包
+     * @param pack_size 当前数据包总长度(含已接收部分)
+     */
+    void reserve_ahead(const size_type& pack_size) const
+    {
+        reserve_ = pack_size;
+    }
+
+    /**
+     * @brief 按上个周期的最高水位收缩容量, 并以当前数据长度开始新的统计周期
+     */
+    void trim()
+    {
+        shrink();
+        high_water_ = size_;
+    }
+
+    /**
+     * @brief 缓存为空时释放全部内存, 下次写入时重新申请
+     */
+    void release()
+    {
+        if (empty())
+        {
+            slab_.reset();
+            storage_ = nullptr;
+            capacity_ = 0;
+            offset_ = 0;
+            high_water_ = 0;
+        }
     }
 
     char* writable_buff()
     {
-        if (container_.size() <= offset_ + size_)
+        size_type required = std::max(size_ + 1, reserve_);
+        if (offset_ > 0 && slab_.use_count() > 1)
         {
-            // 偏移量大于一次申请长度时移动否则扩容
-            if (offset_ >= constant::per_alloc_size)
+            // 内存被视图保留 剩余数据转移到新内存后继续接收
+            reallocate(std::max(capacity_, required));
+        }
+        else if (capacity_ <= offset_ + size_ || capacity_ < offset_ + required)
+        {
+            // 偏移量大于一次申请长度且容量足够时移动否则扩容
+            if (capacity_ >= required && offset_ >= constant::per_alloc_size)
             {
                 move2head();
             }
-            else
+            else if (capacity_ < required || capacity_ <= offset_ + size_)
             {
-                expand();
+                expand(required);
             }
         }
-        return const_cast<char*>(container_.data() + offset_ + size_);
+        return storage_ + offset_ + size_;
     }
 
     size_type writable_size()
     {
-        return container_.size() - offset_ - size_;
+        return capacity_ - offset_ - size_;
     }
 
     void move2head()
     {
+        // 内存被视图保留时不能覆盖 由writable_buff()转移到新内存
+        if (offset_ == 0 || slab_.use_count() > 1)
+        {
+            return;
+        }
         // 将当前有效数据移动到data_起始位置
-        memmove(const_cast<char*>(container_.data()), this->data(), size_);
+        if (size_ > 0)
+        {
+            memmove(storage_, this->data(), size_);
+        }
         // 重置偏移量
         offset_ = 0;
     }
 
 protected:
-    void expand()
+    void expand(const size_type& required)
     {
-        container_.resize(container_.size() + constant::per_alloc_size);
+        // 按倍数增长至max_pack_size 超出后按per_alloc_size线性增长
+        size_type capacity = std::max<size_type>(capacity_ + constant::per_alloc_size, std::min<size_type>(capacity_ * 2, constant::max_pack_size));
+        reallocate(std::max(capacity, required));
     }
+
     void shrink()
     {
-        move2head();
-        container_.resize(std::max<size_type>(constant::initial_size, (size_ + constant::per_alloc_size - 1) / constant::per_alloc_size * constant::per_alloc_size));
+        size_type capacity = std::max<size_type>(constant::initial_size, (std::max(size_, high_water_) + constant::per_alloc_size - 1) / constant::per_alloc_size * constant::per_alloc_size);
+        if (capacity < capacity_)
+        {
+            reallocate(capacity);
+        }
+        else
+        {
+            move2head();
+        }
+    }
+
+    void allocate(const size_type& capacity)
+    {
+        capacity_ = buffer_pool::usable_size(capacity);
+        storage_ = static_cast<char*>(buffer_pool::allocate(capacity_));
+        slab_.reset(storage_, slab_deleter{capacity_}, pool_allocator<char>());
+    }
+
+    void reallocate(const size_type& capacity)
+    {
+        // 新内存不初始化 只拷贝有效数据 原内存由slab_引用计数释放
+        std::shared_ptr<char> slab = std::move(slab_);
+        char* storage = storage_;
+        allocate(capacity);
+        if (size_ > 0)
+        {
+            memcpy(storage_, storage + offset_, size_);
+        }
+        offset_ = 0;
     }
 
+    struct slab_deleter
+    {
+        size_type capacity_;
+        void operator()(char* storage) const
+        {
+            buffer_pool::deallocate(storage, capacity_);
+        }
+    };
+
 protected:
-    buff_type container_;   // 数据容器
-    size_type offset_;      // 有效数据位置
-    size_type size_;        // 有效数据长度
+    std::shared_ptr<char> slab_;    // 内存块引用
+    char* storage_{nullptr};    // 数据容器
+    size_type capacity_{0};     // 容器长度
+    size_type offset_{0};       // 有效数据位置
+    size_type size_{0};         // 有效数据长度
+    size_type high_water_{0};   // 统计周期内最高水位
+    mutable size_type reserve_{0};  // 预留提示
 };
 
 
 } // namespace utility
 } // namespace dy
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,187 @@
+#ifndef DY_NET_BUFFER_POOL_H
+#define DY_NET_BUFFER_POOL_H
+
+#include <cstddef>
+#include <new>
+
+#include "common/comm_def.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 分级内存池
+ * 按2的幂划分尺寸等级(64B~64K), 每个线程维护各等级的空闲链表, 分配/释放无锁且不清零
+ * 超过最大等级的申请直接使用operator new
+ */
+class buffer_pool
+{
+public:
+    using size_type = std::size_t;
+
+    enum constant : size_type
+    {
+        min_class_shift     = 6,                // 最小等级 64B
+        max_class_shift     = 16,               // 最大等级 64K
+        class_count         = max_class_shift - min_class_shift + 1,
+        max_cached_bytes    = 256 * 1024,       // 每线程每等级最多缓存字节数
+    };
+
+    static void* allocate(const size_type& size)
+    {
+        size_type index = class_index(size);
+        if (index >= constant::class_count)
+        {
+            return ::operator new(size);
+        }
+        thread_cache* cache = local_cache();
+        if (cache && cache->heads_[index])
+        {
+            free_node* node = cache->heads_[index];
+            cache->heads_[index] = node->next_;
+            --cache->counts_[index];
+            return node;
+        }
+        return ::operator new(class_size(index));
+    }
+
+    static void deallocate(void* ptr, const size_type& size)
+    {
+        if (!ptr)
+        {
+            return;
+        }
+        size_type index = class_index(size);
+        if (index >= constant::class_count)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+        thread_cache* cache = local_cache();
+        if (cache && cache->counts_[index] < constant::max_cached_bytes / class_size(index))
+        {
+            free_node* node = static_cast<free_node*>(ptr);
+            node->next_ = cache->heads_[index];
+            cache->heads_[index] = node;
+            ++cache->counts_[index];
+            return;
+        }
+        ::operator delete(ptr);
+    }
+
+    /**
+     * @brief 申请size字节实际可用的长度(所在等级的块大小)
+     */
+    static size_type usable_size(const size_type& size)
+    {
+        size_type index = class_index(size);
+        return index < constant::class_count ? class_size(index) : size;
+    }
+
+private:
+    struct free_node
+    {
+        free_node* next_;
+    };
+
+    struct thread_cache
+    {
+        free_node* heads_[constant::class_count] = {};
+        size_type counts_[constant::class_count] = {};
+
+        ~thread_cache()
+        {
+            cache_destroyed() = true;
+            for (size_type i = 0; i < constant::class_count; ++i)
+            {
+                while (heads_[i])
+                {
+                    free_node* node = heads_[i];
+                    heads_[i] = node->next_;
+                    ::operator delete(node);
+                }
+            }
+        }
+    };
+
+    static bool& cache_destroyed()
+    {
+        static thread_local bool destroyed = false;
+        return destroyed;
+    }
+
+    static thread_cache* local_cache()
+    {
+        // 线程退出析构缓存后 后续释放直接归还系统
+        if (cache_destroyed())
+        {
+            return nullptr;
+        }
+        static thread_local thread_cache cache;
+        return &cache;
+    }
+
+    static size_type class_index(size_type size)
+    {
+        size_type index = 0;
+        size = size > 0 ? (size - 1) >> constant::min_class_shift : 0;
+        while (size)
+        {
+            size >>= 1;
+            ++index;
+        }
+        return index;
+    }
+
+    static size_type class_size(const size_type& index)
+    {
+        return size_type(1) << (index + constant::min_class_shift);
+    }
+};
+
+/**
+ * @brief 基于buffer_pool的分配器, 配合std::allocate_shared使对象与控制块同样走内存池
+ */
+template<class T>
+class pool_allocator
+{
+public:
+    using value_type = T;
+
+    pool_allocator() noexcept
+    {
+    }
+
+    template<class U>
+    pool_allocator(const pool_allocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(buffer_pool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        buffer_pool::deallocate(ptr, n * sizeof(T));
+    }
+
+    template<class U>
+    bool operator==(const pool_allocator<U>&) const noexcept
+    {
+        return true;
+    }
+
+    template<class U>
+    bool operator!=(const pool_allocator<U>&) const noexcept
+    {
+        return false;
+    }
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
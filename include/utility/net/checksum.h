@@ -0,0 +1,152 @@
+#ifndef DY_NET_CHECKSUM_H
+#define DY_NET_CHECKSUM_H
+
+#include <string.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DY_CHECKSUM_X86 1
+#include <emmintrin.h>
+#include <nmmintrin.h>
+#endif
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 校验和
+ * crc32c: 运行时检测CPU, 支持SSE4.2时使用crc32指令, 否则查表
+ * additive: 逐字节累加和, SSE2下每次累加16字节
+ * 两者均支持分段计算, 上一段的结果作为下一段的初值
+ */
+class checksum
+{
+public:
+    using size_type = std::size_t;
+
+    static std::uint32_t crc32c(const char* data, const size_type& length, const std::uint32_t& crc = 0)
+    {
+        static const crc32c_func_type func = select_crc32c();
+        return func(data, length, crc);
+    }
+
+    static std::uint32_t additive(const char* data, const size_type& length, const std::uint32_t& sum = 0)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        std::uint32_t result = sum;
+        size_type i = 0;
+#if defined(__SSE2__)
+        // psadbw每8字节求和到64位通道 累加后再合并
+        const __m128i zero = _mm_setzero_si128();
+        __m128i total = zero;
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+            total = _mm_add_epi64(total, _mm_sad_epu8(block, zero));
+        }
+        std::uint64_t lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), total);
+        result += static_cast<std::uint32_t>(lanes[0] + lanes[1]);
+#endif
+        for (; i < length; ++i)
+        {
+            result += bytes[i];
+        }
+        return result;
+    }
+
+    /**
+     * @brief 是否使用硬件crc32c
+     */
+    static bool hardware_crc32c()
+    {
+#if defined(DY_CHECKSUM_X86)
+        return __builtin_cpu_supports("sse4.2");
+#else
+        return false;
+#endif
+    }
+
+private:
+    using crc32c_func_type = std::uint32_t (*)(const char*, const size_type&, const std::uint32_t&);
+
+    static crc32c_func_type select_crc32c()
+    {
+#if defined(DY_CHECKSUM_X86)
+        if (hardware_crc32c())
+        {
+            return &crc32c_hardware;
+        }
+#endif
+        return &crc32c_software;
+    }
+
+#if defined(DY_CHECKSUM_X86)
+    __attribute__((target("sse4.2")))
+    static std::uint32_t crc32c_hardware(const char* data, const size_type& length, const std::uint32_t& crc)
+    {
+        size_type i = 0;
+#if defined(__x86_64__)
+        std::uint64_t value = ~crc;
+        for (; i + 8 <= length; i += 8)
+        {
+            std::uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            value = _mm_crc32_u64(value, word);
+        }
+        std::uint32_t result = static_cast<std::uint32_t>(value);
+#else
+        std::uint32_t result = ~crc;
+        for (; i + 4 <= length; i += 4)
+        {
+            std::uint32_t word;
+            memcpy(&word, data + i, sizeof(word));
+            result = _mm_crc32_u32(result, word);
+        }
+#endif
+        for (; i < length; ++i)
+        {
+            result = _mm_crc32_u8(result, static_cast<unsigned char>(data[i]));
+        }
+        return ~result;
+    }
+#endif
+
+    static std::uint32_t crc32c_software(const char* data, const size_type& length, const std::uint32_t& crc)
+    {
+        static const crc32c_table table;
+        std::uint32_t result = ~crc;
+        for (size_type i = 0; i < length; ++i)
+        {
+            result = table.values_[(result ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (result >> 8);
+        }
+        return ~result;
+    }
+
+    struct crc32c_table
+    {
+        std::uint32_t values_[256];
+
+        crc32c_table()
+        {
+            // Castagnoli多项式(反射)
+            for (std::uint32_t i = 0; i < 256; ++i)
+            {
+                std::uint32_t value = i;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    value = (value & 1) ? (value >> 1) ^ 0x82F63B78u : (value >> 1);
+                }
+                values_[i] = value;
+            }
+        }
+    };
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
@@ -28,8 +28,11 @@ public:
     using mutex_type = typename TSession::mutex_type;
     using lock_guard_type = typename TSession::lock_guard_type;
     using size_type = typename TSession::size_type;
+    using prepared_sptr_type = typename TSession::prepared_sptr_type;
     using func_pack_parse_type = typename TSession::func_pack_parse_type;
     using func_receive_cb_type = typename TSession::func_receive_cb_type;
+    using func_receive_view_cb_type = typename TSession::func_receive_view_cb_type;
+    using func_receive_batch_cb_type = typename TSession::func_receive_batch_cb_type;
     using func_disconn_cb_type = typename TSession::func_disconn_cb_type;
 
 private:
@@ -48,8 +51,14 @@ private:
     session_ptr_type session_ptr_{nullptr};
     func_pack_parse_type pack_parse_method_;
     func_receive_cb_type receive_callback_;
+    func_receive_view_cb_type receive_view_callback_;
+    func_receive_batch_cb_type receive_batch_callback_;
     func_disconn_cb_type disconnect_callback_;
     size_type send_queue_capacity_{8192u};
+    std::shared_ptr<timer_wheel> timer_wheel_;
+    std::shared_ptr<heartbeat_service> heartbeat_service_;
+    size_type recv_budget_packets_{0};
+    size_type recv_budget_bytes_{0};
 
 public:
     socket_client(asio::io_context& ioc) : ioc_(ioc), socket_(ioc_)
@@ -76,6 +85,46 @@ public:
         disconnect_callback_ = disconnect_callback;
     }
 
+    void set_receive_view_callback(func_receive_view_cb_type receive_view_callback)
+    {
+        lock_guard_type lk(mutex_);
+        receive_view_callback_ = receive_view_callback;
+    }
+
+    void set_receive_batch_callback(func_receive_batch_cb_type receive_batch_callback)
+    {
+        lock_guard_type lk(mutex_);
+        receive_batch_callback_ = receive_batch_callback;
+    }
+
+    /**
+     * @brief 新建会话使用的时间轮
+     */
+    void set_timer_wheel(std::shared_ptr<timer_wheel> wheel)
+    {
+        lock_guard_type lk(mutex_);
+        timer_wheel_ = std::move(wheel);
+    }
+
+    /**
+     * @brief 新建会话使用的心跳服务
+     */
+    void set_heartbeat_service(std::shared_ptr<heartbeat_service> service)
+    {
+        lock_guard_type lk(mutex_);
+        heartbeat_service_ = std::move(service);
+    }
+
+    /**
+     * @brief 新建会话的单轮解包预算, 见socket_session::set_recv_budget()
+     */
+    void set_recv_budget(const size_type& packets, const size_type& bytes)
+    {
+        lock_guard_type lk(mutex_);
+        recv_budget_packets_ = packets;
+        recv_budget_bytes_ = bytes;
+    }
+
     void set_options(const std::string &login_data, const bool& auto_reconnect = false,
                      const std::string &heartbeat_data = "", const int &heartbeat_interval = 10, 
                      const int &send_timeout = 30, const int &recv_timeout = 30)
@@ -139,12 +188,74 @@ public:
         disconnect();
     }
 
-    int async_send(const char* data, const buffer::size_type& length)
+    int async_send(const char* data, const buffer::size_type& length, const size_type& priority = session_type::priority_normal)
+    {
+        lock_guard_type lk(mutex_);
+        if (session_ptr_)
+        {
+            return session_ptr_->async_send(data, length, priority);
+        }
+        else
+        {
+            return error_code::session_not_exist;
+        }
+    }
+
+    int async_send(std::string&& data, const size_type& priority = session_type::priority_normal)
+    {
+        lock_guard_type lk(mutex_);
+        if (session_ptr_)
+        {
+            return session_ptr_->async_send(std::move(data), priority);
+        }
+        else
+        {
+            return error_code::session_not_exist;
+        }
+    }
+
+    int async_send(std::vector<char>&& data, const size_type& priority = session_type::priority_normal)
+    {
+        lock_guard_type lk(mutex_);
+        if (session_ptr_)
+        {
+            return session_ptr_->async_send(std::move(data), priority);
+        }
+        else
+        {
+            return error_code::session_not_exist;
+        }
+    }
+
+    template<class T, class TDeleter>
+    int async_send(std::unique_ptr<T, TDeleter>&& data, const buffer::size_type& length, const size_type& priority = session_type::priority_normal)
+    {
+        lock_guard_type lk(mutex_);
+        if (session_ptr_)
+        {
+            return session_ptr_->async_send(std::move(data), length, priority);
+        }
+        else
+        {
+            return error_code::session_not_exist;
+        }
+    }
+
+    prepared_sptr_type prepare_send(const buffer::size_type& length)
+    {
+        if (length == 0 || length > buffer::constant::max_pack_size)
+        {
+            return nullptr;
+        }
+        return make_send_buffer(length);
+    }
+
+    int commit_send(prepared_sptr_type prepared, const buffer::size_type& length, const size_type& priority = session_type::priority_normal)
     {
         lock_guard_type lk(mutex_);
         if (session_ptr_)
         {
-            return session_ptr_->async_send(data, length);
+            return session_ptr_->commit_send(std::move(prepared), length, priority);
         }
         else
         {
@@ -166,6 +277,23 @@ private:
                                                               send_queue_capacity_);
                 session_ptr_->set_session_id(++unique_ssid_);
                 session_ptr_->set_options(send_timeout_, recv_timeout_, heartbeat_interval_, heart_data_);
+                if (receive_view_callback_)
+                {
+                    session_ptr_->set_receive_view_callback(receive_view_callback_);
+                }
+                if (receive_batch_callback_)
+                {
+                    session_ptr_->set_receive_batch_callback(receive_batch_callback_);
+                }
+                if (timer_wheel_)
+                {
+                    session_ptr_->set_timer_wheel(timer_wheel_);
+                }
+                if (heartbeat_service_)
+                {
+                    session_ptr_->set_heartbeat_service(heartbeat_service_);
+                }
+                session_ptr_->set_recv_budget(recv_budget_packets_, recv_budget_bytes_);
                 session_ptr_->start();
                 session_ptr_->async_send(login_data_.c_str(), login_data_.length());
 
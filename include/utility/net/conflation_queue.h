@@ -0,0 +1,98 @@
+#ifndef DY_NET_CONFLATION_QUEUE_H
+#define DY_NET_CONFLATION_QUEUE_H
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include "common/comm_def.h"
+#include "net/buffer_pool.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 按键合并的队列
+ * 同一键尚未取出时再次入队, 新值原地替换旧值并保持原有排队位置, 队列长度不超过键的数量
+ * 用于慢速消费者只关心每个键最新状态的场景(如按合约推送行情)
+ */
+template<class TKey, class TValue>
+class conflation_queue
+{
+public:
+    using key_type = TKey;
+    using value_type = TValue;
+    using size_type = std::size_t;
+    using mutex_type = std::mutex;
+    using lock_guard_type = std::lock_guard<mutex_type>;
+    using order_type = std::deque<key_type, pool_allocator<key_type>>;
+    using pending_type = std::unordered_map<key_type, value_type, std::hash<key_type>, std::equal_to<key_type>,
+                                            pool_allocator<std::pair<const key_type, value_type>>>;
+
+private:
+    mutable mutex_type mutex_;
+    order_type order_;          // 排队顺序
+    pending_type pending_;      // 各键待取出的最新值
+    std::atomic<size_type> size_{0};
+
+public:
+    DISABLE_COPY_ASSIGN(conflation_queue);
+    conflation_queue() = default;
+
+    /**
+     * @brief 入队, 键已在队列中时替换其值
+     * @param replaced 被替换的旧值
+     * @return 是否替换了旧值
+     */
+    bool push(const key_type& key, value_type value, value_type& replaced)
+    {
+        lock_guard_type lk(mutex_);
+        auto iter = pending_.find(key);
+        if (iter != pending_.end())
+        {
+            replaced = std::move(iter->second);
+            iter->second = std::move(value);
+            return true;
+        }
+        pending_.emplace(key, std::move(value));
+        order_.push_back(key);
+        size_.store(order_.size(), std::memory_order_release);
+        return false;
+    }
+
+    bool pop(value_type& value)
+    {
+        if (empty())
+        {
+            return false;
+        }
+        lock_guard_type lk(mutex_);
+        if (order_.empty())
+        {
+            return false;
+        }
+        auto iter = pending_.find(order_.front());
+        value = std::move(iter->second);
+        pending_.erase(iter);
+        order_.pop_front();
+        size_.store(order_.size(), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return size_.load(std::memory_order_acquire) == 0;
+    }
+
+    size_type size() const
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
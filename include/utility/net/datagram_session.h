@@ -0,0 +1,502 @@
+#ifndef DY_NET_DATAGRAM_SESSION_H
+#define DY_NET_DATAGRAM_SESSION_H
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <vector>
+
+#include "net/session.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 数据报描述, 数据只在回调期间有效
+ */
+struct datagram
+{
+    const char* data;                           // 数据
+    std::size_t size;                           // 长度
+    const asio::ip::udp::endpoint* sender;      // 发送方地址
+};
+
+/**
+ * @brief 数据报会话(Linux)
+ * 保留消息边界, 每次系统调用通过recvmmsg/sendmmsg批量收发最多batch_size个数据报, 整批回调给业务层
+ * 超过datagram_size的数据报被截断, 截断的数据报丢弃并计数, 不回调
+ * 发送超过max_datagram_size的数据在入队时拒绝; 单个数据报发送失败(端口不可达/超长)只丢弃该数据报, 不停止会话
+ * async_send可在任意线程调用, 其余设置须在start()前调用
+ * TExecution: locked_execution 加锁; bound_strand_execution socket已绑定到strand(可与其他会话共用), 收发路径不加锁
+ */
+template<class TExecution = locked_execution>
+class basic_datagram_session : public session
+{
+public:
+    using self_type = basic_datagram_session<TExecution>;
+    using execution_type = TExecution;
+    using session_mutex_type = typename execution_type::mutex_type;
+    using session_lock_type = std::lock_guard<session_mutex_type>;
+    using socket_type = asio::ip::udp::socket;
+    using endpoint_type = asio::ip::udp::endpoint;
+    using buff_sptr_type = std::shared_ptr<const send_buffer>;
+    using func_datagram_cb_type = std::function<void(const sessionid_type& /*session id*/, const datagram* /*datagrams*/, const size_type& /*count*/)>;
+
+    enum constant : size_type
+    {
+        batch_size_default    = 64,     // 单次系统调用最多收发数据报数
+        datagram_size_default = dy::utility::constant::frame_segment_length,   // 单个数据报接收缓存长度 与frame_segmenter默认段长一致 超出的数据报被丢弃
+        batch_rounds          = 16,     // 单次最多连续收发批次 避免独占io线程
+        max_datagram_size     = 65507,  // 单个UDP数据报最大长度(IPv4 65535-IP头20-UDP头8)
+    };
+
+private:
+    struct send_item
+    {
+        buff_sptr_type buff_;
+        endpoint_type endpoint_;        // 目的地址 端口为0时发往已连接地址
+    };
+    using queue_type = mpsc_queue<send_item>;
+
+    session_mutex_type mutex_;      // Mutex(strand模式下为空锁)
+    boost::system::error_code adopt_error_;     // socket绑定执行模式失败的原因(须在socket_前初始化)
+    socket_type socket_;
+    std::string local_address_;                 // 构造时记录的本端地址 查询时不访问socket
+    std::string remote_address_;                // 构造时记录的对端地址
+    std::atomic_bool closed_{false};            // 已关闭 供async_send等无锁路径判断, 不直接访问socket
+    func_datagram_cb_type func_datagram_callback_;
+    size_type batch_size_{constant::batch_size_default};
+    size_type datagram_size_{constant::datagram_size_default};
+
+    std::vector<char> recv_slab_;               // 接收缓存 batch_size_个datagram_size_长度的槽位
+    std::vector<iovec> recv_iovecs_;
+    std::vector<mmsghdr> recv_msgs_;
+    std::vector<endpoint_type> recv_senders_;
+    std::vector<datagram> recv_datagrams_;
+    std::atomic<std::uint64_t> recv_truncated_{0};  // 因超长被截断丢弃的数据报
+
+    queue_type send_queue_;                     // 发送队列(无锁 多生产者单消费者)
+    std::atomic<size_type> send_queue_size_{0};
+    std::atomic_bool send_idle_{false};
+    size_type send_queue_capacity_;
+    std::vector<send_item> send_batch_;         // 待发送批次
+    size_type send_batch_pos_{0};               // 批次中已发送个数
+    std::vector<iovec> send_iovecs_;
+    std::vector<mmsghdr> send_msgs_;
+
+public:
+    explicit basic_datagram_session(socket_type socket,
+                                    func_datagram_cb_type datagram_callback,
+                                    func_disconn_cb_type disconnect_callback,
+                                    const size_type& send_queue_capacity = 0) noexcept
+        : session(disconnect_callback),
+          socket_(execution_type::adopt(std::move(socket), adopt_error_)),
+          func_datagram_callback_(datagram_callback),
+          send_queue_capacity_(send_queue_capacity)
+    {
+        closed_ = !socket_.is_open();
+        boost::system::error_code ec;
+        auto local = socket_.local_endpoint(ec);
+        if (!ec)
+        {
+            local_address_ = local.address().to_string();
+        }
+        auto remote = socket_.remote_endpoint(ec);
+        if (!ec)
+        {
+            remote_address_ = remote.address().to_string();
+        }
+    }
+
+    virtual ~basic_datagram_session()
+    {
+        close();
+    }
+
+    /**
+     * @brief 设置批量收发参数
+     * @param batch_size 单次系统调用最多收发的数据报数
+     * @param datagram_size 单个数据报接收缓存长度, 超出的数据报被丢弃并计入truncated()
+     */
+    void set_batch(const size_type& batch_size, const size_type& datagram_size)
+    {
+        session_lock_type lk(mutex_);
+        batch_size_ = std::max<size_type>(batch_size, 1);
+        datagram_size_ = std::max<size_type>(datagram_size, 1);
+    }
+
+    /**
+     * @brief 因超过datagram_size被丢弃的数据报数
+     */
+    std::uint64_t truncated() const
+    {
+        return recv_truncated_.load(std::memory_order_relaxed);
+    }
+
+    virtual void start() override
+    {
+        if (execution_type::serialized)
+        {
+            // 投递到strand执行
+            asio::dispatch(socket_.get_executor(), std::bind(&self_type::handle_start, std::dynamic_pointer_cast<self_type>(shared_from_this())));
+        }
+        else
+        {
+            handle_start();
+        }
+    }
+
+    virtual void stop() override
+    {
+        if (execution_type::serialized)
+        {
+            // 投递到strand执行
+            asio::dispatch(socket_.get_executor(), std::bind(&self_type::close, std::dynamic_pointer_cast<self_type>(shared_from_this())));
+        }
+        else
+        {
+            close();
+        }
+    }
+
+    virtual bool stopped() override
+    {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+    void close()
+    {
+        session_lock_type lk(mutex_);
+        closed_.store(true, std::memory_order_release);
+        if (socket_.is_open())
+        {
+            boost::system::error_code ec;
+            socket_.close(ec);
+        }
+    }
+
+    /**
+     * @brief 发送到已连接地址
+     */
+    int async_send(const char* data, const buffer::size_type& length)
+    {
+        if (!data || length == 0 || length > constant::max_datagram_size)
+        {
+            return error_code::normal_error;
+        }
+        return async_send_to(make_send_buffer(data, length), endpoint_type());
+    }
+
+    int async_send(const buff_sptr_type& payload)
+    {
+        return async_send_to(payload, endpoint_type());
+    }
+
+    int async_send_to(const char* data, const buffer::size_type& length, const endpoint_type& endpoint)
+    {
+        if (!data || length == 0 || length > constant::max_datagram_size)
+        {
+            return error_code::normal_error;
+        }
+        return async_send_to(make_send_buffer(data, length), endpoint);
+    }
+
+    int async_send_to(const buff_sptr_type& payload, const endpoint_type& endpoint)
+    {
+        if (!payload || payload->empty() || payload->size() > constant::max_datagram_size)
+        {
+            return error_code::normal_error;
+        }
+
+        if (stopped())
+        {
+            return error_code::session_stopped;
+        }
+        if (send_queue_size_.fetch_add(1) >= send_queue_capacity_ && send_queue_capacity_ > 0)
+        {
+            send_queue_size_.fetch_sub(1);
+            return error_code::queue_full;
+        }
+        send_queue_.push(send_item{payload, endpoint});
+        wake_writer();
+        return error_code::ok;
+    }
+
+    /**
+     * @brief 本端地址, 构造时记录, 可在任意线程调用, 关闭后返回空
+     */
+    const std::string local_endpoint() override
+    {
+        return stopped() ? "" : local_address_;
+    }
+
+    /**
+     * @brief 对端地址(已连接时), 构造时记录, 可在任意线程调用, 关闭后返回空
+     */
+    const std::string remote_endpoint() override
+    {
+        return stopped() ? "" : remote_address_;
+    }
+
+private:
+    void handle_start()
+    {
+        if (adopt_error_)
+        {
+            // socket未能绑定到strand 直接停止
+            handle_stop(adopt_error_.value(), adopt_error_.message());
+            return;
+        }
+        {
+            session_lock_type lk(mutex_);
+            disconnected_ = false;
+            prepare_batch();
+        }
+        handle_recv();
+        handle_send();
+    }
+
+    /**
+     * @brief 生产者入队后调用, 发送链空闲时才投递唤醒
+     */
+    void wake_writer()
+    {
+        if (send_idle_.load() && send_idle_.exchange(false))
+        {
+            asio::post(socket_.get_executor(), std::bind(&self_type::handle_send, std::dynamic_pointer_cast<self_type>(shared_from_this())));
+        }
+    }
+
+    void prepare_batch()
+    {
+        recv_slab_.resize(batch_size_ * datagram_size_);
+        recv_iovecs_.resize(batch_size_);
+        recv_msgs_.resize(batch_size_);
+        recv_senders_.resize(batch_size_);
+        recv_datagrams_.resize(batch_size_);
+        for (size_type i = 0; i < batch_size_; ++i)
+        {
+            recv_iovecs_[i].iov_base = &recv_slab_[i * datagram_size_];
+            recv_iovecs_[i].iov_len = datagram_size_;
+        }
+        send_batch_.reserve(batch_size_);
+        send_iovecs_.resize(batch_size_);
+        send_msgs_.resize(batch_size_);
+    }
+
+    void handle_stop(const int& error, const std::string& message)
+    {
+        if (!disconnected_)
+        {
+            disconnected_ = true;
+            if (func_disconnect_callback_)
+            {
+                func_disconnect_callback_(session_id(), error, message);
+            }
+        }
+        {
+            session_lock_type lk(mutex_);
+            closed_.store(true, std::memory_order_release);
+            if (socket_.is_open())
+            {
+                boost::system::error_code ec;
+                socket_.close(ec);
+            }
+            send_item item;
+            while (send_queue_.pop(item))
+            {
+                --send_queue_size_;
+            }
+            send_batch_.clear();
+            send_batch_pos_ = 0;
+        }
+    }
+
+    void handle_recv()
+    {
+        session_lock_type lk(mutex_);
+        if (stopped())
+        {
+            return;
+        }
+        auto self_ = std::dynamic_pointer_cast<self_type>(shared_from_this());
+        socket_.async_wait(socket_type::wait_read, [this, self_](std::error_code ec) {
+            if (ec)
+            {
+                // 接收异常 停止
+                handle_stop(ec.value(), ec.message());
+                return;
+            }
+            for (size_type round = 0; round < constant::batch_rounds; ++round)
+            {
+                int count = 0;
+                int error = 0;
+                {
+                    session_lock_type lk(mutex_);
+                    if (stopped())
+                    {
+                        return;
+                    }
+                    for (size_type i = 0; i < batch_size_; ++i)
+                    {
+                        msghdr& hdr = recv_msgs_[i].msg_hdr;
+                        hdr.msg_name = recv_senders_[i].data();
+                        hdr.msg_namelen = static_cast<socklen_t>(recv_senders_[i].capacity());
+                        hdr.msg_iov = &recv_iovecs_[i];
+                        hdr.msg_iovlen = 1;
+                        hdr.msg_control = nullptr;
+                        hdr.msg_controllen = 0;
+                        hdr.msg_flags = 0;
+                    }
+                    count = ::recvmmsg(socket_.native_handle(), recv_msgs_.data(), static_cast<unsigned int>(batch_size_), MSG_DONTWAIT, nullptr);
+                    error = errno;
+                }
+                if (count < 0)
+                {
+                    if (error == EAGAIN || error == EWOULDBLOCK)
+                    {
+                        break;
+                    }
+                    if (error == EINTR || error == ECONNREFUSED)
+                    {
+                        continue;
+                    }
+                    // 接收异常 停止
+                    handle_stop(error, ::strerror(error));
+                    return;
+                }
+                size_type delivered = 0;
+                for (int i = 0; i < count; ++i)
+                {
+                    if (recv_msgs_[i].msg_hdr.msg_flags & MSG_TRUNC)
+                    {
+                        // 数据报超过槽位长度 内容不完整 丢弃
+                        recv_truncated_.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+                    recv_senders_[i].resize(recv_msgs_[i].msg_hdr.msg_namelen);
+                    recv_datagrams_[delivered].data = &recv_slab_[i * datagram_size_];
+                    recv_datagrams_[delivered].size = recv_msgs_[i].msg_len;
+                    recv_datagrams_[delivered].sender = &recv_senders_[i];
+                    ++delivered;
+                }
+                if (delivered > 0)
+                {
+                    // 整批回调给业务层
+                    func_datagram_callback_(session_id(), recv_datagrams_.data(), delivered);
+                }
+                if (static_cast<size_type>(count) < batch_size_)
+                {
+                    // 已读空
+                    break;
+                }
+            }
+            // 继续等待可读
+            handle_recv();
+        });
+    }
+
+    void handle_send()
+    {
+        int error = 0;
+        {
+            session_lock_type lk(mutex_);
+            if (stopped())
+            {
+                return;
+            }
+            for (size_type round = 0; ; ++round)
+            {
+                // 从发送队列补充批次
+                if (send_batch_pos_ == send_batch_.size())
+                {
+                    if (round >= constant::batch_rounds && !send_queue_.empty())
+                    {
+                        // 让出io线程 稍后继续发送
+                        asio::post(socket_.get_executor(), std::bind(&self_type::handle_send, std::dynamic_pointer_cast<self_type>(shared_from_this())));
+                        return;
+                    }
+                    send_batch_.clear();
+                    send_batch_pos_ = 0;
+                    send_item item;
+                    while (send_batch_.size() < batch_size_ && send_queue_.pop(item))
+                    {
+                        --send_queue_size_;
+                        send_batch_.emplace_back(std::move(item));
+                    }
+                }
+                if (send_batch_.empty())
+                {
+                    // 无数据时标记空闲 由生产者入队后唤醒
+                    // 标记后需再检查一次 防止与生产者入队交错时错过唤醒
+                    send_idle_.store(true);
+                    if (!send_queue_.empty() && send_idle_.exchange(false))
+                    {
+                        continue;
+                    }
+                    return;
+                }
+                size_type count = send_batch_.size() - send_batch_pos_;
+                for (size_type i = 0; i < count; ++i)
+                {
+                    send_item& item = send_batch_[send_batch_pos_ + i];
+                    send_iovecs_[i].iov_base = const_cast<char*>(item.buff_->data());
+                    send_iovecs_[i].iov_len = item.buff_->size();
+                    msghdr& hdr = send_msgs_[i].msg_hdr;
+                    hdr.msg_name = item.endpoint_.port() != 0 ? item.endpoint_.data() : nullptr;
+                    hdr.msg_namelen = item.endpoint_.port() != 0 ? static_cast<socklen_t>(item.endpoint_.size()) : 0;
+                    hdr.msg_iov = &send_iovecs_[i];
+                    hdr.msg_iovlen = 1;
+                    hdr.msg_control = nullptr;
+                    hdr.msg_controllen = 0;
+                    hdr.msg_flags = 0;
+                }
+                int sent = ::sendmmsg(socket_.native_handle(), send_msgs_.data(), static_cast<unsigned int>(count), MSG_DONTWAIT);
+                if (sent >= 0)
+                {
+                    send_batch_pos_ += sent;
+                    continue;
+                }
+                error = errno;
+                if (error == EINTR)
+                {
+                    continue;
+                }
+                if (error == EAGAIN || error == EWOULDBLOCK)
+                {
+                    // 发送缓存已满 等待可写
+                    auto self_ = std::dynamic_pointer_cast<self_type>(shared_from_this());
+                    socket_.async_wait(socket_type::wait_write, [this, self_](std::error_code ec) {
+                        if (ec)
+                        {
+                            handle_stop(ec.value(), ec.message());
+                            return;
+                        }
+                        handle_send();
+                    });
+                    return;
+                }
+                if (error == ECONNREFUSED || error == EMSGSIZE)
+                {
+                    // 对端端口不可达(ICMP)或超过路径MTU限制 丢弃当前数据报
+                    ++send_batch_pos_;
+                    continue;
+                }
+                break;
+            }
+        }
+        // 发送异常 停止
+        handle_stop(error, ::strerror(error));
+    }
+};
+
+// explicit class declaration
+using datagram_session = basic_datagram_session<locked_execution>;
+using strand_datagram_session = basic_datagram_session<bound_strand_execution>;
+
+} // namespace utility
+} // namespace dy
+
+#endif
@@ -0,0 +1,263 @@
+#ifndef DY_NET_FEED_ARBITRATOR_H
+#define DY_NET_FEED_ARBITRATOR_H
+
+#include <chrono>
+#include <limits>
+
+#include "net/multicast_receiver.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 多路冗余行情仲裁(A/B线路)
+ * 各线路接收相同序号的数据报, 按序号去重, 先到的一份直接交付, 并统计各线路领先/落后情况
+ * 所有线路在同一strand上回调, 仲裁过程不加锁; 交付的数据指向线路接收缓存, 不拷贝
+ * 某线路缺失而由另一线路补到的数据报可能晚于更大序号交付, 计入out_of_order
+ */
+class feed_arbitrator : public std::enable_shared_from_this<feed_arbitrator>
+{
+public:
+    using size_type = std::size_t;
+    using sessionid_type = session::sessionid_type;
+    using sequence_type = sequence_field::sequence_type;
+    using receiver_ptr_type = std::shared_ptr<multicast_receiver>;
+    using func_datagram_cb_type = multicast_receiver::func_datagram_cb_type;
+    using func_disconn_cb_type = session::func_disconn_cb_type;
+    using strand_type = multicast_receiver::strand_type;
+    using clock_type = std::chrono::steady_clock;
+    using counter_type = multicast_receiver::counter_type;
+
+    enum constant : size_type
+    {
+        window_size_default = 4096,     // 去重窗口(序号数) 须为2的幂
+    };
+
+    /**
+     * @brief 线路统计快照
+     */
+    struct line_statistics
+    {
+        std::uint64_t wins_;            // 先到并交付的数据报
+        std::uint64_t duplicates_;      // 晚于其他线路到达的数据报
+        std::uint64_t lag_total_ns_;    // 晚到时间合计
+        std::uint64_t lag_max_ns_;      // 最大晚到时间
+        multicast_receiver::statistics receiver_;   // 线路自身的丢包统计
+    };
+
+    /**
+     * @brief 仲裁统计快照
+     */
+    struct statistics
+    {
+        std::uint64_t delivered_;       // 交付的数据报
+        std::uint64_t duplicates_;      // 丢弃的重复数据报
+        std::uint64_t stale_;           // 超出去重窗口被丢弃的数据报
+        std::uint64_t out_of_order_;    // 晚于更大序号交付的数据报
+    };
+
+private:
+    struct line
+    {
+        receiver_ptr_type receiver_;
+        counter_type wins_{0};
+        counter_type duplicates_{0};
+        counter_type lag_total_ns_{0};
+        counter_type lag_max_ns_{0};
+    };
+
+    struct slot
+    {
+        sequence_type sequence_;        // 窗口内该位置最近交付的序号
+        clock_type::rep arrival_;       // 首份到达时间
+    };
+
+    strand_type strand_;
+    sequence_field sequence_field_;
+    size_type window_mask_;
+    std::vector<slot> window_;          // 去重窗口 按序号取模
+    sequence_type highest_{0};          // 已交付的最大序号
+    bool synchronized_{false};
+    std::vector<std::unique_ptr<line>> lines_;
+    std::vector<datagram> delivered_;   // 过滤后的回调批次
+    func_datagram_cb_type func_datagram_callback_;
+    func_disconn_cb_type func_disconnect_callback_;
+
+    counter_type delivered_count_{0};
+    counter_type duplicates_{0};
+    counter_type stale_{0};
+    counter_type out_of_order_{0};
+
+public:
+    DISABLE_COPY_ASSIGN(feed_arbitrator);
+
+    /**
+     * @param datagram_callback 仲裁后的数据报(session id为线路序号)
+     * @param window_size 去重窗口, 按2的幂向上取整
+     */
+    explicit feed_arbitrator(asio::io_context& ioc,
+                             func_datagram_cb_type datagram_callback,
+                             func_disconn_cb_type disconnect_callback,
+                             const size_type& window_size = constant::window_size_default)
+        : strand_(asio::make_strand(ioc)),
+          func_datagram_callback_(datagram_callback),
+          func_disconnect_callback_(disconnect_callback)
+    {
+        size_type size = 1;
+        while (size < window_size)
+        {
+            size <<= 1;
+        }
+        window_mask_ = size - 1;
+        window_.assign(size, slot{std::numeric_limits<sequence_type>::max(), 0});
+    }
+
+    ~feed_arbitrator()
+    {
+        stop();
+    }
+
+    /**
+     * @brief 设置序号字段, 须在add_line()前设置, 见multicast_receiver::set_sequence()
+     */
+    void set_sequence(const size_type& offset, const size_type& length = 4, const bool& big_endian = true)
+    {
+        sequence_field_.set(offset, length, big_endian);
+    }
+
+    /**
+     * @brief 增加一条线路, 须在start()前调用, 线路序号按加入顺序从0开始
+     */
+    int add_line(const std::string& group, const unsigned short& port, const std::string& interface_address = "",
+                 const int& recv_buffer_size = multicast_receiver::constant::recv_buffer_size_default)
+    {
+        std::weak_ptr<feed_arbitrator> weak_self = shared_from_this();
+        auto receiver = std::make_shared<multicast_receiver>(strand_,
+            [weak_self](const sessionid_type& line_index, const datagram* datagrams, const size_type& count) {
+                auto self = weak_self.lock();
+                if (self)
+                {
+                    self->handle_datagrams(line_index, datagrams, count);
+                }
+            },
+            nullptr, func_disconnect_callback_);
+        receiver->set_session_id(lines_.size());
+        receiver->set_sequence(sequence_field_.offset_, sequence_field_.length_, sequence_field_.big_endian_);
+        int result = receiver->join(group, port, interface_address, recv_buffer_size);
+        if (result != error_code::ok)
+        {
+            return result;
+        }
+        lines_.emplace_back(new line());
+        lines_.back()->receiver_ = receiver;
+        return error_code::ok;
+    }
+
+    void start()
+    {
+        for (auto& item : lines_)
+        {
+            item->receiver_->start();
+        }
+    }
+
+    void stop()
+    {
+        for (auto& item : lines_)
+        {
+            item->receiver_->stop();
+        }
+    }
+
+    size_type line_count() const
+    {
+        return lines_.size();
+    }
+
+    line_statistics get_line_statistics(const size_type& line_index) const
+    {
+        const line& item = *lines_.at(line_index);
+        return line_statistics{item.wins_.load(std::memory_order_relaxed),
+                               item.duplicates_.load(std::memory_order_relaxed),
+                               item.lag_total_ns_.load(std::memory_order_relaxed),
+                               item.lag_max_ns_.load(std::memory_order_relaxed),
+                               item.receiver_->get_statistics()};
+    }
+
+    statistics get_statistics() const
+    {
+        return statistics{delivered_count_.load(std::memory_order_relaxed),
+                          duplicates_.load(std::memory_order_relaxed),
+                          stale_.load(std::memory_order_relaxed),
+                          out_of_order_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    void handle_datagrams(const sessionid_type& line_index, const datagram* datagrams, const size_type& count)
+    {
+        if (line_index >= lines_.size())
+        {
+            return;
+        }
+        line& source = *lines_[line_index];
+        if (delivered_.size() < count)
+        {
+            delivered_.resize(count);
+        }
+        // 同一批次共用到达时间
+        clock_type::rep now = clock_type::now().time_since_epoch().count();
+        size_type delivered = 0;
+        for (size_type i = 0; i < count; ++i)
+        {
+            sequence_type sequence = 0;
+            if (!sequence_field_.read(datagrams[i].data, datagrams[i].size, sequence))
+            {
+                continue;
+            }
+            slot& entry = window_[sequence & window_mask_];
+            if (entry.sequence_ == sequence)
+            {
+                // 其他线路已交付 统计本线路落后时间
+                std::uint64_t lag = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::duration(now - entry.arrival_)).count());
+                increase_counter(duplicates_);
+                increase_counter(source.duplicates_);
+                increase_counter(source.lag_total_ns_, lag);
+                if (lag > source.lag_max_ns_.load(std::memory_order_relaxed))
+                {
+                    source.lag_max_ns_.store(lag, std::memory_order_relaxed);
+                }
+                continue;
+            }
+            if (synchronized_ && sequence + window_mask_ < highest_)
+            {
+                // 超出去重窗口 无法判断是否重复 丢弃
+                increase_counter(stale_);
+                continue;
+            }
+            if (!synchronized_ || sequence > highest_)
+            {
+                highest_ = sequence;
+                synchronized_ = true;
+            }
+            else
+            {
+                increase_counter(out_of_order_);
+            }
+            entry.sequence_ = sequence;
+            entry.arrival_ = now;
+            increase_counter(source.wins_);
+            delivered_[delivered++] = datagrams[i];
+        }
+        if (delivered > 0)
+        {
+            increase_counter(delivered_count_, delivered);
+            func_datagram_callback_(line_index, delivered_.data(), delivered);
+        }
+    }
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef DY_NET_FRAME_CODEC_H
+#define DY_NET_FRAME_CODEC_H
+
+#include <string.h>
+
+#include <cstdint>
+#include <tuple>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "net/session.h"
+#include "net/checksum.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 帧头, 本机字节序
+ */
+#pragma pack(push, 1)
+struct frame_header
+{
+    std::uint32_t check_bit_;       // 校验字 check_bit_
+    std::uint32_t length_;          // 数据长度(不含帧头)
+    std::int32_t type_;             // 包类型
+    std::uint32_t checksum_;        // 校验和 未启用时为0
+};
+#pragma pack(pop)
+
+/**
+ * @brief 内置帧编解码: 校验字 + 长度 + 类型 + 可选校验和
+ * 帧头校验失败时不断开连接, 用SIMD在缓存中查找下一个校验字, 返回parse_type::skip丢弃其前的数据后重新同步
+ * 可直接作为func_pack_parse_type或functor_policy的TParser使用, 解析出的包含帧头
+ */
+class frame_codec
+{
+public:
+    using size_type = buffer::size_type;
+
+    enum checksum_type { checksum_none, /*不校验*/  checksum_additive, /*累加和*/  checksum_crc32c, /*CRC32C*/ };
+
+    enum constant : size_type
+    {
+        header_length = sizeof(frame_header),
+        max_length_default = dy::utility::constant::max_packet_length,
+    };
+
+private:
+    checksum_type checksum_type_;
+    size_type max_length_;          // 数据最大长度
+    bool verify_;                   // 解析时是否校验
+
+public:
+    /**
+     * @param checksum 编码时生成的校验和类型, 收发双方须一致
+     * @param verify 解析时是否校验, 可信链路上可只生成不校验
+     */
+    explicit frame_codec(const checksum_type& checksum = checksum_none, const size_type& max_length = constant::max_length_default,
+                         const bool& verify = true)
+        : checksum_type_(checksum), max_length_(max_length), verify_(verify)
+    {
+    }
+
+    /**
+     * @brief 写帧头, 数据须已位于frame + header_length处
+     */
+    void encode_header(char* frame, const int& type, const size_type& length) const
+    {
+        frame_header header;
+        header.check_bit_ = check_bit_;
+        header.length_ = static_cast<std::uint32_t>(length);
+        header.type_ = type;
+        header.checksum_ = checksum(frame + constant::header_length, length, type);
+        memcpy(frame, &header, constant::header_length);
+    }
+
+    /**
+     * @brief 编码一帧到frame, frame长度至少为header_length + length
+     */
+    void encode(char* frame, const int& type, const char* data, const size_type& length) const
+    {
+        memcpy(frame + constant::header_length, data, length);
+        encode_header(frame, type, length);
+    }
+
+    /**
+     * @brief 直接在会话的发送缓存中编码并发送一帧
+     */
+    template<class TSession>
+    int send(TSession& session, const int& type, const char* data, const size_type& length,
+             const session::size_type& priority = session::priority_normal) const
+    {
+        if (length > max_length_)
+        {
+            return error_code::normal_error;
+        }
+        auto prepared = session.prepare_send(constant::header_length + length);
+        if (!prepared)
+        {
+            return error_code::normal_error;
+        }
+        encode(prepared->writable_buff(), type, data, length);
+        return session.commit_send(std::move(prepared), constant::header_length + length, priority);
+    }
+
+    template<class TBuffer>
+    session::parse_type operator()(const TBuffer& buff, size_type& pack_size, int& pack_type) const
+    {
+        const char* data = buff.data();
+        size_type size = buff.size();
+        if (size < sizeof(std::uint32_t))
+        {
+            return session::parse_type::less;
+        }
+        frame_header header;
+        memcpy(&header.check_bit_, data, sizeof(header.check_bit_));
+        if (header.check_bit_ != check_bit_)
+        {
+            return resync(data, size, pack_size);
+        }
+        if (size < constant::header_length)
+        {
+            return session::parse_type::less;
+        }
+        memcpy(&header, data, constant::header_length);
+        if (header.length_ > max_length_)
+        {
+            return resync(data, size, pack_size);
+        }
+        if (size < constant::header_length + header.length_)
+        {
+            // 包体未收齐 提示缓存按整包一次扩容
+            buff.reserve_ahead(constant::header_length + header.length_);
+            return session::parse_type::less;
+        }
+        if (verify_ && checksum_type_ != checksum_none && header.checksum_ != checksum(data + constant::header_length, header.length_, header.type_))
+        {
+            return resync(data, size, pack_size);
+        }
+        pack_size = constant::header_length + header.length_;
+        pack_type = header.type_;
+        return session::parse_type::good;
+    }
+
+    template<class TBuffer>
+    std::tuple<session::parse_type, size_type, int> operator()(const TBuffer& buff) const
+    {
+        size_type pack_size = 0;
+        int pack_type = 0;
+        session::parse_type result = (*this)(buff, pack_size, pack_type);
+        return std::make_tuple(result, pack_size, pack_type);
+    }
+
+    /**
+     * @brief 查找校验字
+     * @return 校验字位置, 未找到返回nullptr
+     */
+    static const char* find_check_bit(const char* begin, const char* end)
+    {
+        const char* pos = begin;
+#if defined(__SSE2__)
+        // 按前两个字节批量比较 每次16个位置 命中后再比较完整校验字
+        const __m128i first = _mm_set1_epi8(static_cast<char>(check_bit_ & 0xFF));
+        const __m128i second = _mm_set1_epi8(static_cast<char>((check_bit_ >> 8) & 0xFF));
+        while (pos + 16 + sizeof(std::uint32_t) - 1 <= end)
+        {
+            __m128i block0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+            __m128i block1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + 1));
+            int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block0, first), _mm_cmpeq_epi8(block1, second)));
+            while (mask)
+            {
+                int index = __builtin_ctz(mask);
+                std::uint32_t value;
+                memcpy(&value, pos + index, sizeof(value));
+                if (value == check_bit_)
+                {
+                    return pos + index;
+                }
+                mask &= mask - 1;
+            }
+            pos += 16;
+        }
+#endif
+        for (; pos + sizeof(std::uint32_t) <= end; ++pos)
+        {
+            std::uint32_t value;
+            memcpy(&value, pos, sizeof(value));
+            if (value == check_bit_)
+            {
+                return pos;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    std::uint32_t checksum(const char* data, const size_type& length, const int& type) const
+    {
+        // 长度与类型参与校验
+        std::uint32_t fields[2] = {static_cast<std::uint32_t>(length), static_cast<std::uint32_t>(type)};
+        switch (checksum_type_)
+        {
+        case checksum_additive:
+            return checksum::additive(data, length, fields[0] + fields[1]);
+        case checksum_crc32c:
+            return checksum::crc32c(data, length, checksum::crc32c(reinterpret_cast<const char*>(fields), sizeof(fields)));
+        default:
+            return 0;
+        }
+    }
+
+    /**
+     * @brief 帧头异常 跳到下一个校验字处重新同步
+     */
+    static session::parse_type resync(const char* data, const size_type& size, size_type& pack_size)
+    {
+        const char* pos = find_check_bit(data + 1, data + size);
+        // 未找到时保留末尾可能是校验字前缀的3个字节
+        pack_size = pos ? static_cast<size_type>(pos - data) : size - (sizeof(std::uint32_t) - 1);
+        return session::parse_type::skip;
+    }
+};
+
+// explicit class declaration
+template<class THandler>
+using frame_codec_policy = functor_policy<buffer, frame_codec, THandler>;
+
+} // namespace utility
+} // namespace dy
+
+#endif
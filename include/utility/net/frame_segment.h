@@ -0,0 +1,369 @@
+#ifndef DY_NET_FRAME_SEGMENT_H
+#define DY_NET_FRAME_SEGMENT_H
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "common/comm_def.h"
+#include "common/comm_err.h"
+#include "net/buffer.h"
+#include "net/send_buffer.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 分段头, 每个数据报一段, 本机字节序
+ */
+#pragma pack(push, 1)
+struct segment_header
+{
+    std::uint32_t check_bit_;       // 校验字 check_bit_
+    std::uint32_t frame_id_;        // 帧序号
+    std::uint32_t frame_length_;    // 帧总长度
+    std::uint16_t index_;           // 段序号
+    std::uint16_t count_;           // 段数
+};
+#pragma pack(pop)
+
+/**
+ * @brief 大帧分段发送
+ * 按段长将帧切分为多个数据报(含分段头), 每段使用内存池缓存
+ * 段长不超过链路MTU减去IP/UDP头时才不会产生IP分片: 默认7K只适用于巨帧(jumbo frame)链路, 普通以太网(MTU 1500)应设为1472以下
+ * 接收端datagram_session的datagram_size须不小于段长, 否则分段被截断丢弃; 两者默认值均为frame_segment_length
+ */
+class frame_segmenter
+{
+public:
+    using size_type = std::size_t;
+    using buff_sptr_type = std::shared_ptr<const send_buffer>;
+
+    enum constant : size_type
+    {
+        header_length          = sizeof(segment_header),
+        segment_length_default = dy::utility::constant::frame_segment_length,  // 单个数据报默认最大长度(含分段头)
+        segment_count_max      = 0xFFFF,                                        // 单帧最多段数
+    };
+
+private:
+    std::atomic<std::uint32_t> frame_id_{0};
+    size_type payload_length_;          // 单段最大数据长度
+
+public:
+    DISABLE_COPY_ASSIGN(frame_segmenter);
+
+    /**
+     * @param segment_length 单个数据报最大长度(含分段头), 收发两端须一致
+     */
+    explicit frame_segmenter(const size_type& segment_length = constant::segment_length_default)
+        : payload_length_(payload_length(segment_length))
+    {
+    }
+
+    /**
+     * @brief 段长对应的单段最大数据长度, 至少1字节
+     */
+    static size_type payload_length(const size_type& segment_length)
+    {
+        return segment_length > constant::header_length ? segment_length - constant::header_length : 1;
+    }
+
+    size_type max_frame_length() const
+    {
+        return payload_length_ * constant::segment_count_max;
+    }
+
+    /**
+     * @brief 分段发送一帧
+     * @param session 提供async_send(const buff_sptr_type&)的数据报会话
+     */
+    template<class TSession>
+    int send(TSession& session, const char* data, const size_type& length)
+    {
+        if (!data || length == 0 || length > max_frame_length())
+        {
+            return error_code::normal_error;
+        }
+        segment_header header;
+        header.check_bit_ = check_bit_;
+        header.frame_id_ = ++frame_id_;
+        header.frame_length_ = static_cast<std::uint32_t>(length);
+        header.count_ = static_cast<std::uint16_t>((length + payload_length_ - 1) / payload_length_);
+        for (std::uint16_t index = 0; index < header.count_; ++index)
+        {
+            size_type offset = static_cast<size_type>(index) * payload_length_;
+            size_type payload = std::min<size_type>(payload_length_, length - offset);
+            header.index_ = index;
+            auto segment = make_send_buffer(constant::header_length + payload);
+            memcpy(segment->writable_buff(), &header, constant::header_length);
+            memcpy(segment->writable_buff() + constant::header_length, data + offset, payload);
+            segment->resize(constant::header_length + payload);
+            int result = session.async_send(buff_sptr_type(std::move(segment)));
+            if (result != error_code::ok)
+            {
+                return result;
+            }
+        }
+        return error_code::ok;
+    }
+};
+
+/**
+ * @brief 分段重组
+ * 按(来源, 帧序号)将分段写入内存池缓存, 收齐后回调整帧; 超时未收齐的帧被丢弃
+ * 段长须与发送端frame_segmenter一致, 段数或段内数据长度与之不符的分段视为无效
+ * 每个来源记录最近完成的帧序号, 已完成帧的迟到分段(如A/B线路的另一份)计为重复, 不再新建重组缓存
+ * 同时重组的帧数与缓存总字节数均有上限, 超出时新帧的分段被丢弃
+ * 非线程安全, 应在接收回调所在线程使用
+ */
+class frame_reassembler
+{
+public:
+    using size_type = std::size_t;
+    using source_type = std::uint64_t;
+    using clock_type = std::chrono::steady_clock;
+    using func_frame_cb_type = std::function<void(const source_type& /*source*/, const packet_view& /*frame*/)>;
+
+    /**
+     * @brief 统计
+     */
+    struct statistics
+    {
+        std::uint64_t frames_;          // 重组完成的帧
+        std::uint64_t evicted_;         // 超时丢弃的帧
+        std::uint64_t duplicates_;      // 重复的分段
+        std::uint64_t invalid_;         // 无效的分段
+    };
+
+private:
+    struct frame_key
+    {
+        source_type source_;
+        std::uint32_t frame_id_;
+
+        bool operator==(const frame_key& other) const
+        {
+            return source_ == other.source_ && frame_id_ == other.frame_id_;
+        }
+    };
+
+    struct frame_key_hash
+    {
+        size_type operator()(const frame_key& key) const
+        {
+            return std::hash<source_type>()(key.source_ * 0x9E3779B97F4A7C15ull ^ key.frame_id_);
+        }
+    };
+
+    enum constant : size_type
+    {
+        completed_history = 64,     // 每个来源记录的最近完成帧数
+    };
+
+    /**
+     * @brief 来源最近完成的帧序号(环形)
+     */
+    struct completed_frames
+    {
+        std::vector<std::uint32_t> frame_ids_;
+        size_type next_{0};
+
+        bool contains(const std::uint32_t& frame_id) const
+        {
+            return std::find(frame_ids_.begin(), frame_ids_.end(), frame_id) != frame_ids_.end();
+        }
+
+        void add(const std::uint32_t& frame_id)
+        {
+            if (frame_ids_.size() < constant::completed_history)
+            {
+                frame_ids_.push_back(frame_id);
+                return;
+            }
+            frame_ids_[next_] = frame_id;
+            next_ = (next_ + 1) % constant::completed_history;
+        }
+    };
+
+    struct pending_frame
+    {
+        std::shared_ptr<pooled_send_buffer> buff_;  // 重组缓存
+        std::vector<bool> received_;                // 各段是否已收到
+        std::uint16_t remain_;                      // 未收到的段数
+        clock_type::time_point deadline_;           // 超时时间
+    };
+
+    std::unordered_map<frame_key, pending_frame, frame_key_hash> pending_;
+    std::unordered_map<source_type, completed_frames> completed_;
+    func_frame_cb_type func_frame_callback_;
+    clock_type::duration timeout_;
+    size_type payload_length_;                      // 单段最大数据长度
+    size_type max_frame_length_;
+    size_type max_pending_;                         // 最多同时重组的帧数
+    size_type max_pending_bytes_;                   // 重组缓存总字节数上限
+    size_type pending_bytes_{0};                    // 重组缓存当前总字节数
+    clock_type::time_point next_evict_;
+    statistics statistics_{0, 0, 0, 0};
+
+public:
+    DISABLE_COPY_ASSIGN(frame_reassembler);
+
+    /**
+     * @param timeout 帧从首个分段到收齐的最长时间
+     * @param max_frame_length 允许的最大帧长度
+     * @param segment_length 发送端的段长(含分段头)
+     * @param max_pending_bytes 同时重组的帧缓存总字节数上限
+     */
+    explicit frame_reassembler(func_frame_cb_type frame_callback,
+                               const clock_type::duration& timeout = std::chrono::milliseconds(500),
+                               const size_type& max_frame_length = dy::utility::constant::max_quote_packet_length_32m,
+                               const size_type& max_pending = 1024,
+                               const size_type& segment_length = frame_segmenter::constant::segment_length_default,
+                               const size_type& max_pending_bytes = dy::utility::constant::max_quote_packet_length_32m * 2)
+        : func_frame_callback_(frame_callback),
+          timeout_(timeout),
+          payload_length_(frame_segmenter::payload_length(segment_length)),
+          max_frame_length_(std::min<size_type>(max_frame_length, payload_length_ * frame_segmenter::constant::segment_count_max)),
+          max_pending_(max_pending),
+          max_pending_bytes_(max_pending_bytes),
+          next_evict_(clock_type::now() + timeout)
+    {
+    }
+
+    /**
+     * @brief 输入一个数据报
+     * @param source 来源标识(如发送方地址), 区分不同发送方的帧序号
+     */
+    void feed(const source_type& source, const char* data, const size_type& length)
+    {
+        auto now = clock_type::now();
+        if (now >= next_evict_)
+        {
+            evict(now);
+        }
+
+        segment_header header;
+        if (!data || length < frame_segmenter::constant::header_length)
+        {
+            ++statistics_.invalid_;
+            return;
+        }
+        memcpy(&header, data, frame_segmenter::constant::header_length);
+        size_type payload = length - frame_segmenter::constant::header_length;
+        size_type offset = static_cast<size_type>(header.index_) * payload_length_;
+        // 除末段外每段满长, 长度不符(截断或段长不一致)的分段不能写入
+        if (header.check_bit_ != check_bit_ || header.frame_length_ == 0 || header.frame_length_ > max_frame_length_
+            || header.count_ != (header.frame_length_ + payload_length_ - 1) / payload_length_
+            || header.index_ >= header.count_
+            || payload != std::min<size_type>(payload_length_, header.frame_length_ - offset))
+        {
+            ++statistics_.invalid_;
+            return;
+        }
+
+        frame_key key{source, header.frame_id_};
+        auto iter = pending_.find(key);
+        if (iter == pending_.end())
+        {
+            auto history = completed_.find(source);
+            if (history != completed_.end() && history->second.contains(header.frame_id_))
+            {
+                // 已完成帧的迟到分段
+                ++statistics_.duplicates_;
+                return;
+            }
+            if (pending_.size() >= max_pending_ || pending_bytes_ + header.frame_length_ > max_pending_bytes_)
+            {
+                evict(now);
+                if (pending_.size() >= max_pending_ || pending_bytes_ + header.frame_length_ > max_pending_bytes_)
+                {
+                    ++statistics_.invalid_;
+                    return;
+                }
+            }
+            pending_frame frame;
+            frame.buff_ = make_send_buffer(header.frame_length_);
+            frame.buff_->resize(header.frame_length_);
+            frame.received_.assign(header.count_, false);
+            frame.remain_ = header.count_;
+            frame.deadline_ = now + timeout_;
+            iter = pending_.emplace(key, std::move(frame)).first;
+            pending_bytes_ += header.frame_length_;
+        }
+        pending_frame& frame = iter->second;
+        if (frame.buff_->size() != header.frame_length_ || frame.received_.size() != header.count_)
+        {
+            ++statistics_.invalid_;
+            return;
+        }
+        if (frame.received_[header.index_])
+        {
+            ++statistics_.duplicates_;
+            return;
+        }
+        frame.received_[header.index_] = true;
+        memcpy(frame.buff_->writable_buff() + offset, data + frame_segmenter::constant::header_length, payload);
+        if (--frame.remain_ == 0)
+        {
+            // 收齐 回调整帧 缓存随视图释放归还内存池
+            std::shared_ptr<pooled_send_buffer> buff = std::move(frame.buff_);
+            pending_bytes_ -= buff->size();
+            pending_.erase(iter);
+            completed_[source].add(header.frame_id_);
+            ++statistics_.frames_;
+            func_frame_callback_(source, packet_view(buff, buff->data(), buff->size()));
+        }
+    }
+
+    /**
+     * @brief 丢弃超时未收齐的帧
+     */
+    void evict(const clock_type::time_point& now = clock_type::now())
+    {
+        for (auto iter = pending_.begin(); iter != pending_.end();)
+        {
+            if (iter->second.deadline_ <= now)
+            {
+                pending_bytes_ -= iter->second.buff_->size();
+                iter = pending_.erase(iter);
+                ++statistics_.evicted_;
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+        next_evict_ = now + timeout_ / 2;
+    }
+
+    size_type pending() const
+    {
+        return pending_.size();
+    }
+
+    /**
+     * @brief 重组缓存当前总字节数
+     */
+    size_type pending_bytes() const
+    {
+        return pending_bytes_;
+    }
+
+    const statistics& get_statistics() const
+    {
+        return statistics_;
+    }
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef DY_NET_HEARTBEAT_SERVICE_H
+#define DY_NET_HEARTBEAT_SERVICE_H
+
+#include <atomic>
+#include <vector>
+#include <memory>
+
+#include "common/comm_def.h"
+#include "net/timer_wheel.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 心跳对象接口, 由会话实现
+ */
+class heartbeat_target
+{
+public:
+    using tick_type = timer_wheel::tick_type;
+
+    virtual ~heartbeat_target()
+    {
+    }
+
+    /**
+     * @brief 链路空闲超过心跳间隔时发送心跳
+     * @return false表示已停止 从心跳服务中移除
+     */
+    virtual bool check_idle_heartbeat(const tick_type& now) = 0;
+};
+
+/**
+ * @brief 心跳服务
+ * 挂在时间轮上, 每个周期一次遍历所有会话, 只对空闲链路发送心跳; 遍历与加入都在时间轮strand上执行, io_context可多线程运行
+ * 会话无需各自维护心跳定时器, 繁忙链路不产生心跳流量
+ */
+class heartbeat_service : public std::enable_shared_from_this<heartbeat_service>
+{
+public:
+    using tick_type = timer_wheel::tick_type;
+    using duration_type = timer_wheel::duration_type;
+    using target_wptr_type = std::weak_ptr<heartbeat_target>;
+
+private:
+    std::shared_ptr<timer_wheel> timer_wheel_;
+    tick_type sweep_ticks_;                 // 遍历周期
+    std::atomic_bool stopped_{false};
+    std::vector<target_wptr_type> targets_; // 只在时间轮strand上访问
+
+public:
+    DISABLE_COPY_ASSIGN(heartbeat_service);
+
+    explicit heartbeat_service(std::shared_ptr<timer_wheel> wheel, const duration_type& sweep_interval = asio::chrono::seconds(1))
+        : timer_wheel_(std::move(wheel)), sweep_ticks_(timer_wheel_->to_ticks(sweep_interval))
+    {
+    }
+
+    void start()
+    {
+        stopped_ = false;
+        timer_wheel_->schedule(shared_from_this(), sweep_ticks_, std::bind(&heartbeat_service::sweep, this, std::placeholders::_1));
+    }
+
+    void stop()
+    {
+        stopped_ = true;
+    }
+
+    const std::shared_ptr<timer_wheel>& wheel() const
+    {
+        return timer_wheel_;
+    }
+
+    /**
+     * @brief 加入心跳服务, 可在任意线程调用, 投递到时间轮strand上与遍历串行, 对象停止或释放后自动移除
+     */
+    void add(const std::shared_ptr<heartbeat_target>& target)
+    {
+        auto self = shared_from_this();
+        target_wptr_type weak_target = target;
+        asio::dispatch(timer_wheel_->get_executor(), [self, weak_target]() {
+            self->targets_.emplace_back(weak_target);
+        });
+    }
+
+private:
+    tick_type sweep(const tick_type& now)
+    {
+        if (stopped_)
+        {
+            targets_.clear();
+            return 0;
+        }
+        for (std::size_t i = 0; i < targets_.size();)
+        {
+            auto target = targets_[i].lock();
+            if (!target || !target->check_idle_heartbeat(now))
+            {
+                targets_[i] = std::move(targets_.back());
+                targets_.pop_back();
+                continue;
+            }
+            ++i;
+        }
+        return sweep_ticks_;
+    }
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
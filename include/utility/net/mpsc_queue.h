@@ -0,0 +1,100 @@
+#ifndef DY_NET_MPSC_QUEUE_H
+#define DY_NET_MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+#include "common/comm_def.h"
+#include "net/buffer_pool.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 无锁多生产者单消费者队列(Vyukov MPSC)
+ * push()可被任意线程并发调用, 一次原子交换即可入队; pop()/empty()只能由单一消费者调用
+ * 生产者交换head_后尚未链接next_的短暂窗口内, 消费者可能看到队列为空, 由上层的唤醒机制兜底
+ */
+template<class T>
+class mpsc_queue
+{
+public:
+    using value_type = T;
+
+    DISABLE_COPY_ASSIGN(mpsc_queue);
+
+    mpsc_queue()
+    {
+        node* stub = create_node(T());
+        head_.store(stub, std::memory_order_relaxed);
+        tail_ = stub;
+    }
+
+    ~mpsc_queue()
+    {
+        T value;
+        while (pop(value))
+        {
+        }
+        destroy_node(tail_);
+    }
+
+    void push(T value)
+    {
+        node* item = create_node(std::move(value));
+        node* prev = head_.exchange(item, std::memory_order_acq_rel);
+        prev->next_.store(item, std::memory_order_release);
+    }
+
+    bool pop(T& value)
+    {
+        node* tail = tail_;
+        node* next = tail->next_.load(std::memory_order_acquire);
+        if (!next)
+        {
+            return false;
+        }
+        // next成为新的哨兵节点
+        value = std::move(next->value_);
+        tail_ = next;
+        destroy_node(tail);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return tail_->next_.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct node
+    {
+        std::atomic<node*> next_;
+        T value_;
+
+        explicit node(T&& value) : next_(nullptr), value_(std::move(value))
+        {
+        }
+    };
+
+    static node* create_node(T&& value)
+    {
+        return new (buffer_pool::allocate(sizeof(node))) node(std::move(value));
+    }
+
+    static void destroy_node(node* item)
+    {
+        item->~node();
+        buffer_pool::deallocate(item, sizeof(node));
+    }
+
+private:
+    std::atomic<node*> head_;   // 生产者端(最新入队节点)
+    node* tail_;                // 消费者端(哨兵节点)
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
@@ -0,0 +1,423 @@
+#ifndef DY_NET_MULTICAST_RECEIVER_H
+#define DY_NET_MULTICAST_RECEIVER_H
+
+#include <netinet/in.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "net/datagram_session.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 数据报中的序号字段
+ */
+struct sequence_field
+{
+    using size_type = std::size_t;
+    using sequence_type = std::uint64_t;
+
+    size_type offset_{0};       // 序号在包头中的偏移
+    size_type length_{4};       // 序号长度 4或8字节
+    bool big_endian_{true};     // 网络字节序
+
+    /**
+     * @param length 序号长度 4或8字节, 其他值按4字节处理
+     */
+    void set(const size_type& offset, const size_type& length = 4, const bool& big_endian = true)
+    {
+        offset_ = offset;
+        length_ = length == 8 ? 8 : 4;
+        big_endian_ = big_endian;
+    }
+
+    bool read(const char* data, const size_type& size, sequence_type& sequence) const
+    {
+        if (size < offset_ + length_)
+        {
+            return false;
+        }
+        if (length_ == 8)
+        {
+            std::uint64_t value;
+            ::memcpy(&value, data + offset_, sizeof(value));
+            sequence = big_endian_ ? __builtin_bswap64(value) : value;
+        }
+        else
+        {
+            std::uint32_t value;
+            ::memcpy(&value, data + offset_, sizeof(value));
+            sequence = big_endian_ ? __builtin_bswap32(value) : value;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 下一个序号, 4字节序号在2^32处回绕
+     */
+    sequence_type next(const sequence_type& sequence) const
+    {
+        return length_ == 8 ? sequence + 1 : (sequence + 1) & 0xFFFFFFFFull;
+    }
+
+    /**
+     * @brief 从expected到sequence的有符号距离, 按序号长度回绕比较, 负数表示sequence在expected之前
+     */
+    std::int64_t distance(const sequence_type& expected, const sequence_type& sequence) const
+    {
+        if (length_ == 8)
+        {
+            return static_cast<std::int64_t>(sequence - expected);
+        }
+        return static_cast<std::int32_t>(static_cast<std::uint32_t>(sequence - expected));
+    }
+};
+
+/**
+ * @brief 单线程写入的统计计数 不需要原子加, 其他线程可随时读取
+ */
+inline void increase_counter(std::atomic<std::uint64_t>& counter, const std::uint64_t& value = 1)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 组播行情接收
+ * 在指定网卡上加入一个或多个组播组, 按包头中的序号检测丢包与重复, 只按序号递增顺序整批回调
+ * 只接收本socket加入的组(IP_MULTICAST_ALL=0), 同一端口上其他接收加入的组不会混入
+ * 序号按长度回绕比较(4字节序号回绕后继续递增); 序号回退超过reset_threshold视为行情源重启, 以新序号重新同步并通过缺口回调通知
+ * 收包与回调串行在strand上, 收包路径不加锁; 统计计数只在该strand上写入, 其他线程可随时读取
+ */
+class multicast_receiver : public std::enable_shared_from_this<multicast_receiver>
+{
+public:
+    using size_type = std::size_t;
+    using sessionid_type = session::sessionid_type;
+    using sequence_type = sequence_field::sequence_type;
+    using session_type = strand_datagram_session;
+    using socket_type = session_type::socket_type;
+    using strand_type = asio::strand<asio::io_context::executor_type>;
+    using session_ptr_type = std::shared_ptr<session_type>;
+    using func_datagram_cb_type = session_type::func_datagram_cb_type;
+    using func_disconn_cb_type = session::func_disconn_cb_type;
+    // 序号缺口回调, received小于expected表示源重启后以received重新同步
+    using func_gap_cb_type = std::function<void(const sessionid_type& /*session id*/, const sequence_type& /*expected*/, const sequence_type& /*received*/)>;
+    using counter_type = std::atomic<std::uint64_t>;
+
+    enum constant : size_type
+    {
+        recv_buffer_size_default = 16 * 1024 * 1024,    // socket接收缓存
+        reset_threshold_default  = 1 << 16,             // 序号回退超过该值视为重启
+    };
+
+    /**
+     * @brief 统计快照
+     */
+    struct statistics
+    {
+        std::uint64_t received_;    // 收到的数据报
+        std::uint64_t delivered_;   // 回调的数据报
+        std::uint64_t duplicates_;  // 重复或迟到(序号小于期望)的数据报
+        std::uint64_t gaps_;        // 序号跳跃次数
+        std::uint64_t lost_;        // 跳过的序号数
+        std::uint64_t malformed_;   // 长度不足以读取序号的数据报
+        std::uint64_t resets_;      // 序号重新同步次数(源重启或调用resynchronize)
+    };
+
+private:
+    strand_type strand_;
+    socket_type socket_;
+    session_ptr_type session_ptr_{nullptr};
+    sessionid_type session_id_{0};
+    size_type batch_size_{session_type::constant::batch_size_default};
+    size_type datagram_size_{session_type::constant::datagram_size_default};
+    sequence_field sequence_field_;
+    sequence_type expected_{0};                 // 期望的下一个序号
+    bool synchronized_{false};                  // 已收到首包
+    std::int64_t reset_threshold_{constant::reset_threshold_default};
+    std::vector<datagram> delivered_;           // 过滤后的回调批次
+    func_datagram_cb_type func_datagram_callback_;
+    func_gap_cb_type func_gap_callback_;
+    func_disconn_cb_type func_disconnect_callback_;
+
+    counter_type received_{0};
+    counter_type delivered_count_{0};
+    counter_type duplicates_{0};
+    counter_type gaps_{0};
+    counter_type lost_{0};
+    counter_type malformed_{0};
+    counter_type resets_{0};
+
+public:
+    DISABLE_COPY_ASSIGN(multicast_receiver);
+
+    explicit multicast_receiver(asio::io_context& ioc,
+                                func_datagram_cb_type datagram_callback,
+                                func_gap_cb_type gap_callback,
+                                func_disconn_cb_type disconnect_callback)
+        : multicast_receiver(asio::make_strand(ioc), datagram_callback, gap_callback, disconnect_callback)
+    {
+    }
+
+    /**
+     * @brief 指定strand, 多个接收可共用同一strand, 收包与回调都在该strand上执行, 不加锁
+     */
+    explicit multicast_receiver(const strand_type& strand,
+                                func_datagram_cb_type datagram_callback,
+                                func_gap_cb_type gap_callback,
+                                func_disconn_cb_type disconnect_callback)
+        : strand_(strand),
+          socket_(strand),
+          func_datagram_callback_(datagram_callback),
+          func_gap_callback_(gap_callback),
+          func_disconnect_callback_(disconnect_callback)
+    {
+    }
+
+    ~multicast_receiver()
+    {
+        stop();
+    }
+
+    void set_session_id(const sessionid_type& session_id)
+    {
+        session_id_ = session_id;
+    }
+
+    /**
+     * @brief 设置序号字段, 须在start()前设置
+     * @param offset 序号在包头中的偏移
+     * @param length 序号长度 4或8字节
+     * @param big_endian 是否网络字节序
+     */
+    void set_sequence(const size_type& offset, const size_type& length = 4, const bool& big_endian = true)
+    {
+        sequence_field_.set(offset, length, big_endian);
+    }
+
+    /**
+     * @brief 指定期望的起始序号, 未指定时以首包序号为准
+     */
+    void set_expected_sequence(const sequence_type& sequence)
+    {
+        expected_ = sequence;
+        synchronized_ = true;
+    }
+
+    /**
+     * @brief 序号回退超过threshold时视为行情源重启, 须在start()前设置
+     */
+    void set_reset_threshold(const sequence_type& threshold)
+    {
+        reset_threshold_ = static_cast<std::int64_t>(std::min<sequence_type>(threshold, 0x7FFFFFFF));
+    }
+
+    /**
+     * @brief 以下一个收到的序号重新同步, 可在任意线程调用(投递到strand执行)
+     */
+    void resynchronize()
+    {
+        auto self = shared_from_this();
+        asio::dispatch(strand_, [self]() {
+            self->synchronized_ = false;
+            increase_counter(self->resets_);
+        });
+    }
+
+    /**
+     * @brief 设置批量接收参数, 见datagram_session::set_batch()
+     */
+    void set_batch(const size_type& batch_size, const size_type& datagram_size)
+    {
+        batch_size_ = batch_size;
+        datagram_size_ = datagram_size;
+    }
+
+    /**
+     * @brief 加入组播组, 须在start()前调用, 可多次调用加入同一端口的多个组
+     * @param interface_address 接收网卡地址, 为空时由系统选择
+     */
+    int join(const std::string& group, const unsigned short& port, const std::string& interface_address = "",
+             const int& recv_buffer_size = constant::recv_buffer_size_default)
+    {
+        boost::system::error_code ec;
+        auto group_address = asio::ip::make_address(group, ec);
+        if (ec || !group_address.is_multicast())
+        {
+            return error_code::normal_error;
+        }
+        if (!socket_.is_open())
+        {
+            asio::ip::udp::endpoint listen_endpoint(group_address.is_v4() ? asio::ip::address(asio::ip::address_v4::any())
+                                                                           : asio::ip::address(asio::ip::address_v6::any()), port);
+            socket_.open(listen_endpoint.protocol(), ec);
+            if (!ec)
+            {
+                socket_.set_option(asio::socket_base::reuse_address(true), ec);
+            }
+            if (!ec && recv_buffer_size > 0)
+            {
+                socket_.set_option(asio::socket_base::receive_buffer_size(recv_buffer_size), ec);
+            }
+            if (!ec)
+            {
+                // 绑定在通配地址上 Linux默认会收到本机任意socket在该端口加入的所有组
+                disable_multicast_all(group_address.is_v4(), ec);
+            }
+            if (!ec)
+            {
+                socket_.bind(listen_endpoint, ec);
+            }
+            if (ec)
+            {
+                socket_.close(ec);
+                return error_code::normal_error;
+            }
+        }
+        if (!interface_address.empty() && group_address.is_v4())
+        {
+            auto local_address = asio::ip::make_address_v4(interface_address, ec);
+            if (!ec)
+            {
+                socket_.set_option(asio::ip::multicast::join_group(group_address.to_v4(), local_address), ec);
+            }
+        }
+        else
+        {
+            socket_.set_option(asio::ip::multicast::join_group(group_address), ec);
+        }
+        return ec ? error_code::normal_error : error_code::ok;
+    }
+
+    void start()
+    {
+        if (session_ptr_ || !socket_.is_open())
+        {
+            return;
+        }
+        // 会话回调持有弱引用 避免与会话循环引用
+        std::weak_ptr<multicast_receiver> weak_self = shared_from_this();
+        session_ptr_ = std::make_shared<session_type>(std::move(socket_),
+                                                          [weak_self](const sessionid_type& session_id, const datagram* datagrams, const size_type& count) {
+                                                              auto self = weak_self.lock();
+                                                              if (self)
+                                                              {
+                                                                  self->handle_datagrams(session_id, datagrams, count);
+                                                              }
+                                                          },
+                                                          func_disconnect_callback_);
+        session_ptr_->set_session_id(session_id_);
+        session_ptr_->set_batch(batch_size_, datagram_size_);
+        session_ptr_->start();
+    }
+
+    void stop()
+    {
+        if (session_ptr_)
+        {
+            session_ptr_->stop();
+        }
+    }
+
+    bool stopped()
+    {
+        return !session_ptr_ || session_ptr_->stopped();
+    }
+
+    statistics get_statistics() const
+    {
+        return statistics{received_.load(std::memory_order_relaxed),
+                          delivered_count_.load(std::memory_order_relaxed),
+                          duplicates_.load(std::memory_order_relaxed),
+                          gaps_.load(std::memory_order_relaxed),
+                          lost_.load(std::memory_order_relaxed),
+                          malformed_.load(std::memory_order_relaxed),
+                          resets_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    void disable_multicast_all(const bool& v4, boost::system::error_code& ec)
+    {
+        int value = 0;
+        int result = 0;
+        if (v4)
+        {
+            result = ::setsockopt(socket_.native_handle(), IPPROTO_IP, IP_MULTICAST_ALL, &value, sizeof(value));
+        }
+#if defined(IPV6_MULTICAST_ALL)
+        else
+        {
+            result = ::setsockopt(socket_.native_handle(), IPPROTO_IPV6, IPV6_MULTICAST_ALL, &value, sizeof(value));
+        }
+#endif
+        if (result != 0)
+        {
+            ec.assign(errno, boost::system::system_category());
+        }
+    }
+
+    void handle_datagrams(const sessionid_type& session_id, const datagram* datagrams, const size_type& count)
+    {
+        if (delivered_.size() < count)
+        {
+            delivered_.resize(count);
+        }
+        size_type delivered = 0;
+        for (size_type i = 0; i < count; ++i)
+        {
+            sequence_type sequence = 0;
+            if (!sequence_field_.read(datagrams[i].data, datagrams[i].size, sequence))
+            {
+                increase_counter(malformed_);
+                continue;
+            }
+            increase_counter(received_);
+            if (!synchronized_)
+            {
+                expected_ = sequence;
+                synchronized_ = true;
+            }
+            std::int64_t distance = sequence_field_.distance(expected_, sequence);
+            if (distance < -reset_threshold_)
+            {
+                // 大幅回退 视为行情源重启 以新序号重新同步
+                increase_counter(resets_);
+                if (func_gap_callback_)
+                {
+                    func_gap_callback_(session_id, expected_, sequence);
+                }
+            }
+            else if (distance < 0)
+            {
+                // 重复或迟到 丢弃
+                increase_counter(duplicates_);
+                continue;
+            }
+            else if (distance > 0)
+            {
+                // 丢包 仍按序交付后续数据 由业务层决定是否补数
+                increase_counter(gaps_);
+                increase_counter(lost_, static_cast<std::uint64_t>(distance));
+                if (func_gap_callback_)
+                {
+                    func_gap_callback_(session_id, expected_, sequence);
+                }
+            }
+            expected_ = sequence_field_.next(sequence);
+            delivered_[delivered++] = datagrams[i];
+        }
+        if (delivered > 0)
+        {
+            increase_counter(delivered_count_, delivered);
+            func_datagram_callback_(session_id, delivered_.data(), delivered);
+        }
+    }
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
@@ -0,0 +1,260 @@
+#ifndef DY_NET_RING_BUFFER_H
+#define DY_NET_RING_BUFFER_H
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <algorithm>
+
+#include "common/comm_def.h"
+#include "net/buffer.h"
+#include "net/send_buffer.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 镜像映射环形缓存
+ * 同一组物理页连续映射两次, 跨越尾部的数据包在虚拟地址上依然连续, 无需move2head()整理缓存
+ * 读写接口与buffer一致(data/size/reserve_ahead等), 可作为socket_session的TBuffer使用
+ * 注意解包方法的参数类型随之变为const ring_buffer&: 按const buffer&编写的std::function解包方法须修改签名, 模板解包函数对象(如frame_codec)无需修改
+ * 映射在首次写入时建立, 映射失败(文件描述符或vm.max_map_count耗尽)时writable_buff()返回nullptr, 不抛异常
+ */
+class ring_buffer
+{
+public:
+    using size_type = buffer::size_type;
+
+    enum constant : size_type
+    {
+        max_pack_size  = buffer::constant::max_pack_size,
+        initial_size   = buffer::constant::initial_size,
+    };
+
+    DISABLE_COPY_ASSIGN(ring_buffer);
+
+    explicit ring_buffer(const size_type& capacity = constant::initial_size)
+        : initial_capacity_(capacity)
+    {
+    }
+
+    virtual ~ring_buffer()
+    {
+        unmap();
+    }
+
+    const char* data() const
+    {
+        return base_ + offset_;
+    }
+
+    const size_type& size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    size_type capacity() const
+    {
+        return capacity_;
+    }
+
+    const size_type& high_water() const
+    {
+        return high_water_;
+    }
+
+    void push_cache(const size_type& size)
+    {
+        size_ += size;
+        high_water_ = std::max(high_water_, size_);
+    }
+
+    void pop_cache(const size_type& size)
+    {
+        offset_ += size;
+        if (offset_ >= capacity_)
+        {
+            offset_ -= capacity_;
+        }
+        size_ -= size;
+        reserve_ = 0;
+    }
+
+    void clear()
+    {
+        offset_ = 0;
+        size_ = 0;
+        reserve_ = 0;
+    }
+
+    /**
+     * @brief 保留当前位置起size字节的视图
+     * 映射内存会循环复用 视图数据拷贝到内存池
+     */
+    packet_view retain(const size_type& size) const
+    {
+        auto holder = make_send_buffer(data(), size);
+        return packet_view(holder, holder->data(), size);
+    }
+
+    /**
+     * @brief 预留提示, 解包方法读到包头长度后调用, 下次写入前一次性扩容到可容纳整包
+     */
+    void reserve_ahead(const size_type& pack_size) const
+    {
+        reserve_ = pack_size;
+    }
+
+    /**
+     * @brief 按上个周期的最高水位重新映射较小的容量, 并以当前数据长度开始新的统计周期
+     */
+    void trim()
+    {
+        size_type capacity = std::max<size_type>(constant::initial_size, std::max(size_, high_water_));
+        if (base_ && capacity * 2 <= capacity_)
+        {
+            remap(capacity);
+        }
+        high_water_ = size_;
+    }
+
+    /**
+     * @brief 缓存为空时解除映射, 下次写入时重新映射
+     */
+    void release()
+    {
+        if (empty())
+        {
+            unmap();
+            capacity_ = 0;
+            offset_ = 0;
+            high_water_ = 0;
+        }
+    }
+
+    /**
+     * @return 可写位置, 映射失败时返回nullptr
+     */
+    char* writable_buff()
+    {
+        if (!base_)
+        {
+            if (!map(std::max(initial_capacity_, reserve_)))
+            {
+                return nullptr;
+            }
+        }
+        else if (size_ >= capacity_ || reserve_ > capacity_)
+        {
+            // 缓存已满或不足以容纳整包 扩容
+            if (!expand())
+            {
+                return nullptr;
+            }
+        }
+        return base_ + offset_ + size_;
+    }
+
+    size_type writable_size()
+    {
+        return capacity_ - size_;
+    }
+
+    void move2head()
+    {
+        // 镜像映射下数据始终连续 无需整理
+    }
+
+protected:
+    bool expand()
+    {
+        return remap(std::max(capacity_ * 2, reserve_));
+    }
+
+    // 失败时保留原映射
+    bool remap(const size_type& capacity)
+    {
+        char* old_base = base_;
+        size_type old_capacity = capacity_;
+        size_type old_offset = offset_;
+
+        if (!map(capacity))
+        {
+            return false;
+        }
+        memcpy(base_, old_base + old_offset, size_);
+        ::munmap(old_base, old_capacity * 2);
+        return true;
+    }
+
+    bool map(size_type capacity)
+    {
+        // 容量按页对齐
+        size_type page = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+        capacity = (capacity + page - 1) / page * page;
+
+        int fd = ::memfd_create("dy_ring_buffer", MFD_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+        if (::ftruncate(fd, capacity) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        // 先预留两倍地址空间 再将同一文件映射到前后两半
+        void* addr = ::mmap(nullptr, capacity * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED)
+        {
+            ::close(fd);
+            return false;
+        }
+        char* base = static_cast<char*>(addr);
+        if (::mmap(base, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            ::mmap(base + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+        {
+            ::munmap(base, capacity * 2);
+            ::close(fd);
+            return false;
+        }
+        // 映射建立后即可关闭文件描述符
+        ::close(fd);
+
+        base_ = base;
+        capacity_ = capacity;
+        offset_ = 0;
+        return true;
+    }
+
+    void unmap()
+    {
+        if (base_)
+        {
+            ::munmap(base_, capacity_ * 2);
+            base_ = nullptr;
+        }
+    }
+
+protected:
+    size_type initial_capacity_;// 首次映射长度
+    char* base_{nullptr};       // 映射起始地址
+    size_type capacity_{0};     // 单份映射长度
+    size_type offset_{0};       // 有效数据位置
+    size_type size_{0};         // 有效数据长度
+    size_type high_water_{0};   // 统计周期内最高水位
+    mutable size_type reserve_{0};  // 预留提示
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
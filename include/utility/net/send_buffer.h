@@ -0,0 +1,179 @@
+#ifndef DY_NET_SEND_BUFFER_H
+#define DY_NET_SEND_BUFFER_H
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/comm_def.h"
+#include "net/buffer.h"
+#include "net/buffer_pool.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 发送缓存, 发送队列中的不可变消息
+ * 发送进度由session自行记录, 同一个发送缓存可被多个session共享
+ */
+class send_buffer
+{
+public:
+    using size_type = buffer::size_type;
+
+    DISABLE_COPY_ASSIGN(send_buffer);
+
+    virtual ~send_buffer()
+    {
+        // nothing
+    }
+
+    const char* data() const
+    {
+        return data_;
+    }
+
+    const size_type& size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+protected:
+    send_buffer() = default;
+
+protected:
+    const char* data_{nullptr}; // 数据地址
+    size_type size_{0};         // 数据长度
+};
+
+/**
+ * @brief 内存池分配的发送缓存, 按消息长度精确申请且不清零
+ */
+class pooled_send_buffer : public send_buffer
+{
+public:
+    explicit pooled_send_buffer(const size_type& capacity)
+        : block_(static_cast<char*>(buffer_pool::allocate(capacity))), capacity_(capacity)
+    {
+        data_ = block_;
+    }
+
+    pooled_send_buffer(const char* data, const size_type& length)
+        : pooled_send_buffer(length)
+    {
+        memcpy(block_, data, length);
+        size_ = length;
+    }
+
+    virtual ~pooled_send_buffer()
+    {
+        buffer_pool::deallocate(block_, capacity_);
+    }
+
+    char* writable_buff()
+    {
+        return block_;
+    }
+
+    const size_type& capacity() const
+    {
+        return capacity_;
+    }
+
+    void resize(const size_type& size)
+    {
+        size_ = std::min(size, capacity_);
+    }
+
+protected:
+    char* block_;               // 内存块
+    size_type capacity_;        // 内存块长度
+};
+
+/**
+ * @brief 接管调用方内存的发送缓存, 不拷贝数据
+ * TOwner为std::string/std::vector<char>等连续容器或std::unique_ptr
+ */
+template<class TOwner>
+class owned_send_buffer : public send_buffer
+{
+public:
+    // 容器 移动后再取地址(短字符串移动后地址会变化)
+    explicit owned_send_buffer(TOwner&& owner)
+        : owner_(std::move(owner))
+    {
+        data_ = reinterpret_cast<const char*>(owner_.data());
+        size_ = owner_.size() * sizeof(*owner_.data());
+    }
+
+    // 智能指针 由调用方给出长度
+    owned_send_buffer(TOwner&& owner, const size_type& length)
+        : owner_(std::move(owner))
+    {
+        data_ = reinterpret_cast<const char*>(owner_.get());
+        size_ = length;
+    }
+
+    virtual ~owned_send_buffer()
+    {
+        // owner_析构时释放内存
+    }
+
+protected:
+    TOwner owner_;              // 调用方内存
+};
+
+/**
+ * @brief 拷贝数据到内存池发送缓存, 对象及控制块同样从内存池分配
+ */
+inline std::shared_ptr<send_buffer> make_send_buffer(const char* data, const send_buffer::size_type& length)
+{
+    return std::allocate_shared<pooled_send_buffer>(pool_allocator<pooled_send_buffer>(), data, length);
+}
+
+/**
+ * @brief 申请可写的内存池发送缓存, 调用方直接写入writable_buff()后提交发送
+ */
+inline std::shared_ptr<pooled_send_buffer> make_send_buffer(const send_buffer::size_type& capacity)
+{
+    return std::allocate_shared<pooled_send_buffer>(pool_allocator<pooled_send_buffer>(), capacity);
+}
+
+/**
+ * @brief 接管字符串内存
+ */
+inline std::shared_ptr<send_buffer> make_send_buffer(std::string&& data)
+{
+    return std::allocate_shared<owned_send_buffer<std::string>>(pool_allocator<owned_send_buffer<std::string>>(), std::move(data));
+}
+
+/**
+ * @brief 接管vector内存
+ */
+inline std::shared_ptr<send_buffer> make_send_buffer(std::vector<char>&& data)
+{
+    return std::allocate_shared<owned_send_buffer<std::vector<char>>>(pool_allocator<owned_send_buffer<std::vector<char>>>(), std::move(data));
+}
+
+/**
+ * @brief 接管unique_ptr内存, 发送完成后由其删除器释放
+ */
+template<class T, class TDeleter>
+inline std::shared_ptr<send_buffer> make_send_buffer(std::unique_ptr<T, TDeleter>&& data, const send_buffer::size_type& length)
+{
+    using owner_type = std::unique_ptr<T, TDeleter>;
+    return std::allocate_shared<owned_send_buffer<owner_type>>(pool_allocator<owned_send_buffer<owner_type>>(), std::move(data), length);
+}
+
+} // namespace utility
+} // namespace dy
+
+#endif
@@ -3,13 +3,19 @@
 
 #include "common/common.h"
 
-#include <queue>
+#include <deque>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 
 #include <boost/asio.hpp>
 
 #include "net/buffer.h"
+#include "net/ring_buffer.h"
+#include "net/send_buffer.h"
+#include "net/mpsc_queue.h"
+#include "net/conflation_queue.h"
+#include "net/heartbeat_service.h"
 
 namespace dy
 {
@@ -17,6 +23,24 @@ namespace utility
 {
 namespace asio = boost::asio;
 
+/**
+ * @brief 是否为数据报socket(UDP), 数据报不能将多条消息合并为一次发送
+ */
+template<class TSocket>
+struct is_datagram_socket : std::is_same<typename TSocket::protocol_type, asio::ip::udp>
+{
+};
+
+/**
+ * @brief 批量接收回调中的数据包描述, 数据指向接收缓存, 仅在回调期间有效
+ */
+struct packet_desc
+{
+    int type;                                   // 包类型
+    const char* data;                           // 数据
+    std::size_t size;                           // 长度
+};
+
 /**
  * @brief Session
  */
@@ -31,9 +55,15 @@ public:
     using timer_type = asio::steady_timer;
     using time_point_type = timer_type::time_point;
 
-    enum parse_type { good, /*解析成功*/  bad, /*解析出错*/  less, /*缺少数据*/  indeterminate, /*尚未明确*/ };
+    enum parse_type { good, /*解析成功*/  bad, /*解析出错*/  less, /*缺少数据*/  indeterminate, /*尚未明确*/  skip, /*丢弃pack length字节后重新解析*/ };
+    // 发送优先级(发送通道) 数值越小越优先
+    enum send_priority : size_type { priority_urgent, priority_high, priority_normal, priority_bulk, priority_count };
+    // 发送通道调度方式
+    enum send_schedule { schedule_strict, /*严格优先级*/  schedule_weighted, /*按权重轮转*/ };
     using func_pack_parse_type = std::function<std::tuple<parse_type /*parse type*/, buffer::size_type /*pack length*/, int /*pack type*/>(const buffer&)>;
     using func_receive_cb_type = std::function<void(const sessionid_type& /*session id*/, const int& /*pack type*/, const char* /*data buff*/, const buffer::size_type& /*length*/)>;
+    using func_receive_view_cb_type = std::function<void(const sessionid_type& /*session id*/, const int& /*pack type*/, const packet_view& /*packet*/)>;
+    using func_receive_batch_cb_type = std::function<void(const sessionid_type& /*session id*/, const packet_desc* /*packets*/, const size_type& /*count*/)>;
     using func_disconn_cb_type = std::function<void(const sessionid_type& /*session id*/, const int& /*reason code*/, const std::string& /*message*/)>;
     using func_log_type        = std::function<void(const int& /*type*/, const char* /*message*/)>;
 
@@ -41,15 +71,15 @@ protected:
     sessionid_type session_id_{0};
     std::atomic_bool disconnected_{false};
 
-    func_pack_parse_type func_pack_parse_method_;
-    func_receive_cb_type func_receive_callback_;
+    func_receive_view_cb_type func_receive_view_callback_;
+    func_receive_batch_cb_type func_receive_batch_callback_;
     func_disconn_cb_type func_disconnect_callback_;
 
 public:
     DISABLE_COPY_ASSIGN(session);
 
-    explicit session(func_pack_parse_type pack_parse_method, func_receive_cb_type receive_callback, func_disconn_cb_type disconnect_callback)
-        : func_pack_parse_method_(pack_parse_method), func_receive_callback_(receive_callback), func_disconnect_callback_(disconnect_callback)
+    explicit session(func_disconn_cb_type disconnect_callback)
+        : func_disconnect_callback_(disconnect_callback)
     {
     }
 
@@ -78,32 +108,260 @@ public:
     }
 };
 
-template<class TSocket, class TBuffer>
-class socket_session : public session
+/**
+ * @brief 默认解包/回调策略, 通过std::function调用, 运行时可替换
+ * 自定义策略需提供以下成员, 由socket_session直接调用可被内联:
+ *  session::parse_type parse(const TBuffer& buff, buffer::size_type& pack_size, int& pack_type);
+ *  void receive(const session::sessionid_type& session_id, const int& pack_type, const char* data, const buffer::size_type& length);
+ */
+template<class TBuffer>
+class function_policy
+{
+public:
+    using func_pack_parse_type = std::function<std::tuple<session::parse_type /*parse type*/, buffer::size_type /*pack length*/, int /*pack type*/>(const TBuffer&)>;
+    using func_receive_cb_type = session::func_receive_cb_type;
+
+private:
+    func_pack_parse_type func_pack_parse_method_;
+    func_receive_cb_type func_receive_callback_;
+
+public:
+    function_policy(func_pack_parse_type pack_parse_method, func_receive_cb_type receive_callback)
+        : func_pack_parse_method_(pack_parse_method), func_receive_callback_(receive_callback)
+    {
+    }
+
+    session::parse_type parse(const TBuffer& buff, buffer::size_type& pack_size, int& pack_type)
+    {
+        session::parse_type result = session::parse_type::indeterminate;
+        std::tie(result, pack_size, pack_type) = func_pack_parse_method_(buff);
+        return result;
+    }
+
+    void receive(const session::sessionid_type& session_id, const int& pack_type, const char* data, const buffer::size_type& length)
+    {
+        if (func_receive_callback_)
+        {
+            func_receive_callback_(session_id, pack_type, data, length);
+        }
+    }
+};
+
+/**
+ * @brief 函数对象解包/回调策略, 解包与回调的类型在编译期确定, 调用可被内联
+ * TParser: session::parse_type (const TBuffer& buff, buffer::size_type& pack_size, int& pack_type)
+ * THandler: void (const session::sessionid_type& session_id, const int& pack_type, const char* data, const buffer::size_type& length)
+ */
+template<class TBuffer, class TParser, class THandler>
+class functor_policy
+{
+private:
+    TParser parser_;
+    THandler handler_;
+
+public:
+    explicit functor_policy(TParser parser = TParser(), THandler handler = THandler())
+        : parser_(std::move(parser)), handler_(std::move(handler))
+    {
+    }
+
+    session::parse_type parse(const TBuffer& buff, buffer::size_type& pack_size, int& pack_type)
+    {
+        return parser_(buff, pack_size, pack_type);
+    }
+
+    void receive(const session::sessionid_type& session_id, const int& pack_type, const char* data, const buffer::size_type& length)
+    {
+        handler_(session_id, pack_type, data, length);
+    }
+};
+
+/**
+ * @brief 空锁, strand执行模式下替代std::mutex
+ */
+struct null_mutex
+{
+    void lock()
+    {
+    }
+    void unlock()
+    {
+    }
+};
+
+/**
+ * @brief 加锁执行模式(默认), 会话状态由互斥锁保护, 回调可在任意io线程执行
+ */
+struct locked_execution
+{
+    using mutex_type = std::mutex;
+    enum { serialized = false };
+
+    template<class TSocket>
+    static TSocket adopt(TSocket socket, boost::system::error_code& /*ec*/)
+    {
+        return socket;
+    }
+};
+
+/**
+ * @brief strand执行模式, 会话的所有操作串行在同一个strand上, 不再加锁
+ * 多线程io_context下依然安全; async_send/stop/start可在任意线程调用, 其余设置须在start()前调用
+ */
+struct strand_execution
+{
+    using mutex_type = null_mutex;
+    enum { serialized = true };
+
+    // 将socket重新绑定到新建的strand上 此后socket与定时器的回调都在strand上执行
+    // 在noexcept构造中调用 不抛异常: 失败时关闭socket并通过ec返回, 会话start()时停止
+    template<class TSocket>
+    static TSocket adopt(TSocket socket, boost::system::error_code& ec)
+    {
+        try
+        {
+            TSocket adopted(asio::make_strand(socket.get_executor()));
+            if (!socket.is_open())
+            {
+                return adopted;
+            }
+            auto protocol = socket.local_endpoint(ec).protocol();
+            if (ec)
+            {
+                boost::system::error_code ignored;
+                socket.close(ignored);
+                return adopted;
+            }
+            auto handle = socket.release(ec);
+            if (ec)
+            {
+                boost::system::error_code ignored;
+                socket.close(ignored);
+                return adopted;
+            }
+            adopted.assign(protocol, handle, ec);
+            if (ec)
+            {
+                // 交还原socket关闭 避免句柄泄漏
+                boost::system::error_code ignored;
+                socket.assign(protocol, handle, ignored);
+                socket.close(ignored);
+            }
+            return adopted;
+        }
+        catch (const std::exception&)
+        {
+            ec = asio::error::no_memory;
+            boost::system::error_code ignored;
+            socket.close(ignored);
+            return socket;
+        }
+    }
+};
+
+/**
+ * @brief 外部strand执行模式, socket已绑定到调用方提供的strand上(可由多个会话共用), 不再加锁也不新建strand
+ */
+struct bound_strand_execution
+{
+    using mutex_type = null_mutex;
+    enum { serialized = true };
+
+    template<class TSocket>
+    static TSocket adopt(TSocket socket, boost::system::error_code& /*ec*/)
+    {
+        return socket;
+    }
+};
+
+template<class TSocket, class TBuffer, class TPolicy = function_policy<TBuffer>, class TExecution = locked_execution>
+class socket_session : public session, public heartbeat_target
 {
 public:
+    using self_type = socket_session<TSocket, TBuffer, TPolicy, TExecution>;
     using socket_type = TSocket;
     using buffer_type = TBuffer;
-    using buff_sptr_type = std::shared_ptr<buffer_type>;
-    using queue_type = std::queue<buff_sptr_type>;
+    using policy_type = TPolicy;
+    using execution_type = TExecution;
+    using session_mutex_type = typename execution_type::mutex_type;
+    using session_lock_type = std::lock_guard<session_mutex_type>;
+    using buff_sptr_type = std::shared_ptr<const send_buffer>;
+    using prepared_sptr_type = std::shared_ptr<pooled_send_buffer>;
+    using queue_type = mpsc_queue<buff_sptr_type>;
+    using conflation_key_type = std::uint64_t;
+    using conflation_queue_type = conflation_queue<conflation_key_type, buff_sptr_type>;
+    using batch_type = std::deque<buff_sptr_type>;
+    using iovecs_type = std::vector<asio::const_buffer>;
+    using tick_type = timer_wheel::tick_type;
+    using func_watermark_cb_type = std::function<void(const sessionid_type& /*session id*/, const size_type& /*queued bytes*/)>;
+
+    enum constant : size_type
+    {
+        send_batch_bytes_default = 256 * 1024,  // 单次发送最大字节数
+        send_batch_count_default = 64,          // 单次发送最大消息数(iovec数)
+    };
+    // 解包方法按接收缓存类型定义, 参数为const TBuffer&
+    // 更换TBuffer(如tcp_ring_session)时, 按const buffer&编写的解包方法须改为接收const ring_buffer&(C++11无泛型lambda)
+    // 以模板operator()实现的解包函数对象(如frame_codec)对两种缓存均可直接使用
+    using func_pack_parse_type = typename function_policy<buffer_type>::func_pack_parse_type;
 
 private:
-    mutex_type mutex_;              // Mutex
+    policy_type policy_;            // 解包/回调策略
+
+    session_mutex_type mutex_;      // Mutex(strand模式下为空锁)
+    boost::system::error_code adopt_error_; // socket绑定执行模式失败的原因(须在socket_前初始化)
     socket_type socket_;            // Socket
+    std::string local_address_;     // 构造时记录的本端地址 查询时不访问socket
+    std::string remote_address_;    // 构造时记录的对端地址
+    std::atomic_bool closed_{false};// 已关闭 供无锁路径(生产者/时间轮线程)判断, 不直接访问socket
     buffer_type recv_buffer_;       // 接收缓存
-    queue_type send_queue_;         // 发送队列
+    std::vector<packet_desc> recv_batch_;   // 一次接收解析出的数据包(批量回调)
+    size_type recv_budget_packets_{0};      // 单轮解包数预算 0不限制
+    size_type recv_budget_bytes_{0};        // 单轮解包字节预算 0不限制
+    std::atomic<std::uint64_t> recv_budget_hits_{0};    // 预算用尽次数
+    std::atomic<std::uint64_t> recv_yields_{0};         // 让出io线程次数
+    queue_type send_queues_[priority_count];    // 各优先级发送队列(无锁 多生产者单消费者)
+    send_schedule send_schedule_{schedule_strict};  // 发送通道调度方式
+    size_type send_weights_[priority_count]{8, 4, 2, 1};    // 各通道每轮可取消息数(按权重轮转)
+    size_type send_lane_{0};        // 当前轮转通道
+    size_type send_lane_credit_{0}; // 当前通道本轮剩余可取消息数
+    conflation_queue_type send_conflation_; // 按键合并的发送队列(在bulk通道发送)
+    std::atomic<size_type> send_queue_size_{0};   // 发送队列长度
+    std::atomic_bool send_idle_{false};           // 发送链空闲 生产者入队后需唤醒
     size_type send_queue_capacity_; // 发送队列容量(上限)
-    buff_sptr_type send_buff_ptr_;  // 发送缓存
+    std::atomic<size_type> send_queue_bytes_{0};  // 待发送字节数(含发送中)
+    std::atomic_bool send_congested_{false};      // 超过高水位 尚未回落到低水位
+    size_type send_queue_max_bytes_{0};     // 待发送字节上限 0不限制
+    size_type send_high_watermark_{0};      // 高水位 0不通知
+    size_type send_low_watermark_{0};       // 低水位
+    func_watermark_cb_type func_congested_callback_;
+    func_watermark_cb_type func_writable_callback_;
+    batch_type send_batch_;         // 发送中的消息(聚合发送)
+    size_type send_batch_offset_{0};// 首条消息已发送长度
+    iovecs_type send_iovecs_;       // 聚合发送缓存序列
+    size_type send_batch_bytes_{constant::send_batch_bytes_default};
+    size_type send_batch_count_{is_datagram_socket<TSocket>::value ? 1u : constant::send_batch_count_default};
 
     size_type send_timeout_;        // 发送超时
     size_type recv_timeout_;        // 接收超时
     size_type heartbeat_interval_;  // 心跳间隔
     std::string heartbeat_data_;    // 心跳数据
 
+    size_type recv_idle_shrink_{0}; // 接收缓存收缩周期
+    bool recv_release_idle_{false}; // 空闲时释放接收缓存
+    bool recv_waiting_{false};      // 缓存为空 等待socket可读(接收缓存未被占用)
+
     timer_type recv_deadline_;
     timer_type send_deadline_;
     timer_type heartbeat_timer_;
-    timer_type non_empty_send_queue_;
+    timer_type recv_idle_timer_;    // 接收缓存收缩定时器
+
+    std::shared_ptr<timer_wheel> timer_wheel_;  // 时间轮 设置后替代上面的定时器
+    std::shared_ptr<heartbeat_service> heartbeat_service_;  // 心跳服务 设置后由其统一发送心跳
+    tick_type heartbeat_ticks_{0};              // 心跳间隔tick数
+    buff_sptr_type heartbeat_buff_;             // 心跳数据(共享 发送时不再拷贝)
+    std::atomic<tick_type> last_recv_tick_{0};  // 最近接收的tick
+    std::atomic<tick_type> last_send_tick_{0};  // 最近发送的tick
 
 public:
     explicit socket_session(socket_type socket,
@@ -111,119 +369,452 @@ public:
                             func_receive_cb_type receive_callback,
                             func_disconn_cb_type disconnect_callback,
                             const size_type &send_queue_capacity = 0) noexcept
-        : session(pack_parse_method, receive_callback, disconnect_callback),
-          socket_(std::move(socket)),
+        : socket_session(std::move(socket), policy_type(pack_parse_method, receive_callback), disconnect_callback, send_queue_capacity)
+    {
+    }
+
+    /**
+     * @brief 以编译期策略构造, 解包与回调由policy提供
+     */
+    explicit socket_session(socket_type socket,
+                            policy_type policy,
+                            func_disconn_cb_type disconnect_callback,
+                            const size_type &send_queue_capacity = 0) noexcept
+        : session(disconnect_callback),
+          policy_(std::move(policy)),
+          socket_(execution_type::adopt(std::move(socket), adopt_error_)),
           send_queue_capacity_(send_queue_capacity),
           recv_deadline_(socket_.get_executor()),
           send_deadline_(socket_.get_executor()),
           heartbeat_timer_(socket_.get_executor()),
-          non_empty_send_queue_(socket_.get_executor())
+          recv_idle_timer_(socket_.get_executor())
     {
+        closed_ = !socket_.is_open();
+        boost::system::error_code ec;
+        auto local = socket_.local_endpoint(ec);
+        if (!ec)
+        {
+            local_address_ = local.address().to_string();
+        }
+        auto remote = socket_.remote_endpoint(ec);
+        if (!ec)
+        {
+            remote_address_ = remote.address().to_string();
+        }
         recv_deadline_.expires_at(time_point_type::max());
         send_deadline_.expires_at(time_point_type::max());
         heartbeat_timer_.expires_at(time_point_type::max());
-        non_empty_send_queue_.expires_at(time_point_type::max());
     }
 
     virtual ~socket_session()
     {
-        stop();
+        close();
     }
 
     void set_options(const int& send_timeout = 30, const int& recv_timeout = 30, const int& heartbeat_interval = 10, const std::string& heartbeat_data = "")
     {
-        lock_guard_type lk(mutex_);
+        session_lock_type lk(mutex_);
         send_timeout_ = send_timeout;
         recv_timeout_ = recv_timeout;
         heartbeat_interval_ = heartbeat_interval;
         heartbeat_data_ = heartbeat_data;
     }
 
+    /**
+     * @brief 设置视图接收回调, 设置后替代原接收回调
+     * 回调得到引用计数的数据包视图, 可保留或转交其他线程而无需拷贝
+     */
+    void set_receive_view_callback(func_receive_view_cb_type receive_view_callback)
+    {
+        session_lock_type lk(mutex_);
+        func_receive_view_callback_ = receive_view_callback;
+    }
+
+    /**
+     * @brief 设置批量接收回调, 设置后替代原接收回调与视图接收回调
+     * 每次接收完成后将解析出的全部完整数据包一次回调, 数据指向接收缓存, 回调返回后失效
+     */
+    void set_receive_batch_callback(func_receive_batch_cb_type receive_batch_callback)
+    {
+        session_lock_type lk(mutex_);
+        func_receive_batch_callback_ = receive_batch_callback;
+    }
+
+    /**
+     * @brief 设置接收缓存自适应策略, 须在start()前设置
+     * 启用后缓存为空时只等待socket可读, 不占用接收缓存, 由定时器(或时间轮)按周期收缩
+     * 收到大包后不再有数据的会话, 至多两个周期后回落到初始容量
+     * @param idle_shrink 每隔idle_shrink秒按上个周期内最高水位收缩接收缓存, 0不收缩
+     * @param release_idle 缓存数据处理完后释放全部内存, 等待socket可读时再申请
+     */
+    void set_recv_buffer_options(const int& idle_shrink = 60, const bool& release_idle = false)
+    {
+        session_lock_type lk(mutex_);
+        recv_idle_shrink_ = idle_shrink;
+        recv_release_idle_ = release_idle;
+    }
+
+    /**
+     * @brief 设置单轮解包预算, 须在start()前设置
+     * 一次接收后最多解析packets个包或bytes字节, 用尽后投递到io_context排队继续解析, 避免突发数据长期占用io线程
+     * @param packets 单轮解包数, 0不限制
+     * @param bytes 单轮解包字节数, 0不限制
+     */
+    void set_recv_budget(const size_type& packets, const size_type& bytes)
+    {
+        session_lock_type lk(mutex_);
+        recv_budget_packets_ = packets;
+        recv_budget_bytes_ = bytes;
+    }
+
+    /**
+     * @brief 解包预算用尽次数
+     */
+    std::uint64_t recv_budget_hits() const
+    {
+        return recv_budget_hits_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 因预算用尽让出io线程的次数
+     */
+    std::uint64_t recv_yields() const
+    {
+        return recv_yields_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 使用时间轮管理超时与心跳, 须在start()前设置
+     * 收发路径只记录最近活跃tick, 不再逐次重置定时器
+     */
+    void set_timer_wheel(std::shared_ptr<timer_wheel> wheel)
+    {
+        session_lock_type lk(mutex_);
+        timer_wheel_ = std::move(wheel);
+    }
+
+    /**
+     * @brief 使用心跳服务, 使用其时间轮管理超时, 心跳由服务统一遍历发送, 须在start()前设置
+     */
+    void set_heartbeat_service(std::shared_ptr<heartbeat_service> service)
+    {
+        session_lock_type lk(mutex_);
+        timer_wheel_ = service ? service->wheel() : nullptr;
+        heartbeat_service_ = std::move(service);
+    }
+
+    /**
+     * @brief 按字节设置发送队列限制, 须在start()前设置
+     * @param max_bytes 待发送字节上限, 超过时async_send返回queue_full, 0不限制
+     * @param high_watermark 待发送字节达到高水位时回调on_congested, 0不通知
+     * @param low_watermark 拥塞后回落到低水位时回调on_writable
+     * 回调在生产者线程或io线程中执行(不持有会话锁)
+     */
+    void set_send_watermark(const size_type& max_bytes, const size_type& high_watermark, const size_type& low_watermark,
+                            func_watermark_cb_type on_congested, func_watermark_cb_type on_writable)
+    {
+        session_lock_type lk(mutex_);
+        send_queue_max_bytes_ = max_bytes;
+        send_high_watermark_ = high_watermark;
+        send_low_watermark_ = std::min(low_watermark, high_watermark);
+        func_congested_callback_ = on_congested;
+        func_writable_callback_ = on_writable;
+    }
+
+    /**
+     * @brief 待发送字节数(含发送中)
+     */
+    size_type send_queue_bytes() const
+    {
+        return send_queue_bytes_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 设置发送通道调度方式, 须在start()前设置
+     * @param schedule schedule_strict 总是先发高优先级通道; schedule_weighted 按权重轮转, 低优先级通道不会被饿死
+     * @param weights 各通道每轮可取消息数(按优先级顺序, 仅schedule_weighted使用, 0视为1)
+     */
+    void set_send_schedule(const send_schedule& schedule, const std::vector<size_type>& weights = std::vector<size_type>())
+    {
+        session_lock_type lk(mutex_);
+        send_schedule_ = schedule;
+        for (size_type i = 0; i < weights.size() && i < priority_count; ++i)
+        {
+            send_weights_[i] = std::max<size_type>(weights[i], 1);
+        }
+        send_lane_ = 0;
+        send_lane_credit_ = send_weights_[0];
+    }
+
+    /**
+     * @brief 设置聚合发送上限, 一次发送最多合并max_count条消息/max_bytes字节, 数据报socket固定为1条
+     */
+    void set_send_batch(const size_type& max_bytes, const size_type& max_count)
+    {
+        session_lock_type lk(mutex_);
+        send_batch_bytes_ = std::max<size_type>(max_bytes, 1);
+        send_batch_count_ = is_datagram_socket<TSocket>::value ? 1u : std::max<size_type>(max_count, 1);
+    }
+
     virtual void start() override
     {
-        // 重置断开状态标识
-        disconnected_ = false;
-        // 启动接收/发送链
-        handle_recv();
-        if (recv_timeout_ > 0)
+        if (execution_type::serialized)
         {
-            recv_deadline_.async_wait(std::bind(&socket_session<TSocket, TBuffer>::check_deadline, std::dynamic_pointer_cast<socket_session<TSocket, TBuffer>>(shared_from_this()), std::ref(recv_deadline_)));
+            // 投递到strand执行
+            asio::dispatch(socket_.get_executor(), std::bind(&self_type::handle_start, std::dynamic_pointer_cast<self_type>(shared_from_this())));
         }
-        handle_send();
-        if (send_timeout_ > 0)
+        else
         {
-            send_deadline_.async_wait(std::bind(&socket_session<TSocket, TBuffer>::check_deadline, std::dynamic_pointer_cast<socket_session<TSocket, TBuffer>>(shared_from_this()), std::ref(send_deadline_)));
+            handle_start();
         }
     }
     
     virtual void stop() override
     {
-        lock_guard_type lk(mutex_);
+        if (execution_type::serialized)
+        {
+            // 投递到strand执行
+            asio::dispatch(socket_.get_executor(), std::bind(&self_type::close, std::dynamic_pointer_cast<self_type>(shared_from_this())));
+        }
+        else
+        {
+            close();
+        }
+    }
+    
+    virtual bool stopped() override
+    {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 关闭socket, strand模式下须在strand上调用, 其他线程使用stop()
+     */
+    void close()
+    {
+        session_lock_type lk(mutex_);
         //handle_stop(error_code::normal_error, "active close");
         // 不直接调用handle_stop 关闭socket让连接自行释放
+        closed_.store(true, std::memory_order_release);
         if (socket_.is_open())
         {
-            socket_.close();
+            boost::system::error_code ec;
+            socket_.close(ec);
         }
     }
-    
-    virtual bool stopped() override
+
+    int async_send(const char* data, const buffer::size_type& length, const size_type& priority = priority_normal)
+    {
+        if (!data || length == 0 || length > buffer::constant::max_pack_size)
+        {
+            return error_code::normal_error;
+        }
+        return async_send(make_send_buffer(data, length), priority);
+    }
+
+    /**
+     * @brief 接管调用方的字符串/vector内存发送, 不拷贝
+     */
+    int async_send(std::string&& data, const size_type& priority = priority_normal)
+    {
+        if (data.empty() || data.size() > buffer::constant::max_pack_size)
+        {
+            return error_code::normal_error;
+        }
+        return async_send(make_send_buffer(std::move(data)), priority);
+    }
+
+    int async_send(std::vector<char>&& data, const size_type& priority = priority_normal)
     {
-        return !socket_.is_open();
+        if (data.empty() || data.size() > buffer::constant::max_pack_size)
+        {
+            return error_code::normal_error;
+        }
+        return async_send(make_send_buffer(std::move(data)), priority);
     }
 
-    int async_send(const char* data, const buffer::size_type& length)
+    /**
+     * @brief 接管调用方unique_ptr内存发送, 发送完成后由其删除器释放
+     */
+    template<class T, class TDeleter>
+    int async_send(std::unique_ptr<T, TDeleter>&& data, const buffer::size_type& length, const size_type& priority = priority_normal)
     {
         if (!data || length == 0 || length > buffer::constant::max_pack_size)
         {
             return error_code::normal_error;
         }
+        return async_send(make_send_buffer(std::move(data), length), priority);
+    }
+
+    /**
+     * @brief 申请length字节的可写发送缓存, 调用方直接序列化到writable_buff()后调用commit_send()发送
+     */
+    prepared_sptr_type prepare_send(const buffer::size_type& length)
+    {
+        if (length == 0 || length > buffer::constant::max_pack_size)
+        {
+            return nullptr;
+        }
+        return make_send_buffer(length);
+    }
+
+    /**
+     * @brief 提交prepare_send()申请的缓存, 发送其中前length字节
+     */
+    int commit_send(prepared_sptr_type prepared, const buffer::size_type& length, const size_type& priority = priority_normal)
+    {
+        if (!prepared || length == 0 || length > prepared->capacity())
+        {
+            return error_code::normal_error;
+        }
+        prepared->resize(length);
+        return async_send(buff_sptr_type(std::move(prepared)), priority);
+    }
+
+    /**
+     * @brief 发送共享的不可变数据, 不拷贝数据, 同一payload可同时投递给多个session
+     * 各session独立记录发送进度
+     * @param priority 发送通道, 高优先级通道的数据先于低优先级通道积压的数据发送
+     */
+    int async_send(const buff_sptr_type& payload, const size_type& priority = priority_normal)
+    {
+        if (!payload || payload->empty() || payload->size() > buffer::constant::max_pack_size || priority >= priority_count)
+        {
+            return error_code::normal_error;
+        }
 
-        lock_guard_type lk(mutex_);
         if (stopped())
         {
             return error_code::session_stopped;
         }
-        if (send_queue_capacity_ == 0 || send_queue_.size() < send_queue_capacity_)
+        // 入队不加锁 先占用容量再入队
+        if (send_queue_size_.fetch_add(1) >= send_queue_capacity_ && send_queue_capacity_ > 0)
         {
-            send_queue_.emplace(std::make_shared<buffer>(data, length));
-            non_empty_send_queue_.expires_at(time_point_type::min());
-
-            return error_code::ok;
+            send_queue_size_.fetch_sub(1);
+            return error_code::queue_full;
         }
-        else
+        size_type length = payload->size();
+        size_type queued = send_queue_bytes_.fetch_add(length) + length;
+        if (send_queue_max_bytes_ > 0 && queued > send_queue_max_bytes_)
         {
+            send_queue_bytes_.fetch_sub(length);
+            send_queue_size_.fetch_sub(1);
             return error_code::queue_full;
         }
+        send_queues_[priority].push(payload);
+        if (send_high_watermark_ > 0 && queued >= send_high_watermark_)
+        {
+            handle_congested(queued);
+        }
+        wake_writer();
+        return error_code::ok;
     }
 
-    const std::string local_endpoint() override
+    /**
+     * @brief 按键合并发送, 同一键的消息尚未发出时新消息原地替换旧消息并保持排队位置
+     * 合并队列长度不超过键的数量, 不受发送队列容量与字节上限限制, 在priority_bulk通道发送
+     */
+    int async_send_conflated(const conflation_key_type& key, const buff_sptr_type& payload)
     {
-        lock_guard_type lk(mutex_);
-        if (socket_.is_open())
+        if (!payload || payload->empty() || payload->size() > buffer::constant::max_pack_size)
+        {
+            return error_code::normal_error;
+        }
+
+        if (stopped())
+        {
+            return error_code::session_stopped;
+        }
+        buff_sptr_type replaced;
+        size_type length = payload->size();
+        size_type queued = send_queue_bytes_.fetch_add(length) + length;
+        if (send_conflation_.push(key, payload, replaced))
         {
-            return socket_.local_endpoint().address().to_string();
+            // 替换 释放旧消息占用的字节数
+            queued = send_queue_bytes_.fetch_sub(replaced->size()) - replaced->size();
         }
         else
         {
-            return "";
+            ++send_queue_size_;
         }
+        if (send_high_watermark_ > 0 && queued >= send_high_watermark_)
+        {
+            handle_congested(queued);
+        }
+        wake_writer();
+        return error_code::ok;
     }
 
-    const std::string remote_endpoint() override
+    int async_send_conflated(const conflation_key_type& key, const char* data, const buffer::size_type& length)
     {
-        lock_guard_type lk(mutex_);
-        if (socket_.is_open())
+        if (!data || length == 0 || length > buffer::constant::max_pack_size)
         {
-            return socket_.remote_endpoint().address().to_string();
+            return error_code::normal_error;
         }
-        else
+        return async_send_conflated(key, make_send_buffer(data, length));
+    }
+
+    /**
+     * @brief 本端地址, 构造时记录, 可在任意线程调用, 关闭后返回空
+     */
+    const std::string local_endpoint() override
+    {
+        return stopped() ? "" : local_address_;
+    }
+
+    /**
+     * @brief 对端地址, 构造时记录, 可在任意线程调用, 关闭后返回空
+     */
+    const std::string remote_endpoint() override
+    {
+        return stopped() ? "" : remote_address_;
+    }
+
+    /**
+     * @brief 心跳服务回调(时间轮strand)
+     */
+    virtual bool check_idle_heartbeat(const tick_type& now) override
+    {
+        if (stopped())
         {
-            return "";
+            return false;
         }
+        handle_idle_heartbeat(now);
+        return true;
     }
 
 private:
+    void handle_start()
+    {
+        // 重置断开状态标识
+        disconnected_ = false;
+        if (adopt_error_)
+        {
+            // socket未能绑定到strand 直接停止
+            handle_stop(adopt_error_.value(), adopt_error_.message());
+            return;
+        }
+        if (timer_wheel_)
+        {
+            handle_wheel_start();
+        }
+        // 启动接收/发送链
+        handle_recv();
+        if (!timer_wheel_ && recv_timeout_ > 0)
+        {
+            recv_deadline_.async_wait(std::bind(&self_type::check_deadline, std::dynamic_pointer_cast<self_type>(shared_from_this()), std::ref(recv_deadline_)));
+        }
+        handle_send();
+        if (!timer_wheel_ && send_timeout_ > 0)
+        {
+            send_deadline_.async_wait(std::bind(&self_type::check_deadline, std::dynamic_pointer_cast<self_type>(shared_from_this()), std::ref(send_deadline_)));
+        }
+        if (!timer_wheel_ && recv_idle_shrink_ > 0)
+        {
+            recv_idle_timer_.expires_after(asio::chrono::seconds(recv_idle_shrink_));
+            recv_idle_timer_.async_wait(std::bind(&self_type::check_idle_shrink, std::dynamic_pointer_cast<self_type>(shared_from_this()), std::placeholders::_1));
+        }
+    }
 
     void handle_stop(const int& error, const std::string& message)
     {
@@ -235,7 +826,8 @@ private:
             func_disconnect_callback_(session_id(), error, message);
         }
         {
-            lock_guard_type lk(mutex_);
+            session_lock_type lk(mutex_);
+            closed_.store(true, std::memory_order_release);
             if (socket_.is_open())
             {
                 boost::system::error_code ec;
@@ -244,70 +836,98 @@ private:
             // 终止计时器
             recv_deadline_.cancel();
             send_deadline_.cancel();
-            non_empty_send_queue_.cancel();
             heartbeat_timer_.cancel();
+            recv_idle_timer_.cancel();
             // 清空缓存
             recv_buffer_.clear();
-            queue_type temp_queue;
-            send_queue_.swap(temp_queue);
-            send_buff_ptr_ = nullptr;
+            buff_sptr_type buff;
+            while (pop_send_queue(buff))
+            {
+                --send_queue_size_;
+                send_queue_bytes_ -= buff->size();
+            }
+            for (auto& item : send_batch_)
+            {
+                send_queue_bytes_ -= item->size();
+            }
+            send_batch_.clear();
+            send_batch_offset_ = 0;
         }
     }
 
     void handle_recv()
     {
-        lock_guard_type lk(mutex_);
+        session_lock_type lk(mutex_);
         if (stopped())
         {
             return;
         }
-        if (recv_timeout_ > 0)
+        if (timer_wheel_)
+        {
+            last_recv_tick_.store(timer_wheel_->now(), std::memory_order_relaxed);
+        }
+        else if (recv_timeout_ > 0)
         {
             recv_deadline_.expires_after(asio::chrono::seconds(recv_timeout_));
         }
+        if (recv_buffer_.empty())
+        {
+            // 释放缓存 socket可读时再申请
+            if (recv_release_idle_)
+            {
+                recv_buffer_.release();
+            }
+            // 只等待可读 空闲期间接收缓存可被收缩
+            if (recv_release_idle_ || recv_idle_shrink_ > 0)
+            {
+                recv_waiting_ = true;
+                handle_async_wait_recv();
+                return;
+            }
+        }
         handle_async_recv();
     }
 
+    void handle_async_wait_recv()
+    {
+        auto self_ = std::dynamic_pointer_cast<self_type>(shared_from_this());
+        socket_.async_wait(socket_type::wait_read, [this, self_](std::error_code ec) {
+            if (!ec)
+            {
+                session_lock_type lk(mutex_);
+                recv_waiting_ = false;
+                if (!stopped())
+                {
+                    handle_async_recv();
+                }
+            }
+            else
+            {
+                // 接收异常 停止
+                handle_stop(ec.value(), ec.message());
+            }
+        });
+    }
+
     void handle_async_recv()
     {
-        auto self_ = std::dynamic_pointer_cast<socket_session<TSocket, TBuffer>>(shared_from_this());
-        socket_.async_receive(asio::buffer(recv_buffer_.writable_buff(), recv_buffer_.writable_size()), [this, self_](std::error_code ec, std::size_t bytes_transferred) {
+        auto self_ = std::dynamic_pointer_cast<self_type>(shared_from_this());
+        // writable_buff()可能扩容 须先于writable_size()调用
+        char* writable_buff = recv_buffer_.writable_buff();
+        if (!writable_buff)
+        {
+            // 接收缓存分配失败 调用方可能持有会话锁 投递后停止
+            asio::post(socket_.get_executor(), [this, self_]() {
+                handle_stop(error_code::normal_error, "recv buffer allocation failed");
+            });
+            return;
+        }
+        socket_.async_receive(asio::buffer(writable_buff, recv_buffer_.writable_size()), [this, self_](std::error_code ec, std::size_t bytes_transferred) {
             if (!ec)
             {
                 // 更新接收缓存有效长度
                 recv_buffer_.push_cache(bytes_transferred);
-
-                while (true)
-                {
-                    // 解析接收缓存数据
-                    parse_type result = parse_type::indeterminate;
-                    int pack_type = 0;
-                    int pack_size = 0;
-                    std::tie(result, pack_size, pack_type) = func_pack_parse_method_(recv_buffer_);
-                    if (result == parse_type::good)
-                    {
-                        // 将解析出的包回调给业务层
-                        if (func_receive_callback_)
-                        {
-                            func_receive_callback_(session_id(), pack_type, recv_buffer_.data(), pack_size);
-                        }
-                        recv_buffer_.pop_cache(pack_size);
-                    }
-                    else if (result == parse_type::less)
-                    {
-                        // 整理缓存 继续解包
-                        recv_buffer_.move2head();
-                        // 不足一包 继续接收
-                        handle_recv();
-                        break;
-                    }
-                    else /*(result == parse_type::bad || result == parse_type::indeterminate)*/
-                    {
-                        // 解包异常 停止
-                        handle_stop(error_code::packet_error, "parse failed");
-                        break;
-                    }
-                }
+                handle_parse();
             }
             else
             {
@@ -317,63 +937,249 @@ private:
         });
     }
 
+    /**
+     * @brief 解析接收缓存中的数据包, 超过单轮预算时让出io线程
+     */
+    void handle_parse()
+    {
+        size_type budget_packets = 0;
+        size_type budget_bytes = 0;
+        while (true)
+        {
+            // 本轮预算用尽且仍有数据 已解析的包先回调 让出io线程后继续解包
+            if (budget_exhausted(budget_packets, budget_bytes) && !recv_buffer_.empty())
+            {
+                handle_receive_batch();
+                handle_recv_yield();
+                break;
+            }
+            // 解析接收缓存数据
+            int pack_type = 0;
+            buffer::size_type pack_size = 0;
+            parse_type result = policy_.parse(recv_buffer_, pack_size, pack_type);
+            if (result == parse_type::good)
+            {
+                // 将解析出的包回调给业务层
+                if (func_receive_batch_callback_)
+                {
+                    // 暂存 缓存整理前统一回调
+                    recv_batch_.push_back(packet_desc{pack_type, recv_buffer_.data(), pack_size});
+                }
+                else if (func_receive_view_callback_)
+                {
+                    func_receive_view_callback_(session_id(), pack_type, recv_buffer_.retain(pack_size));
+                }
+                else
+                {
+                    policy_.receive(session_id(), pack_type, recv_buffer_.data(), pack_size);
+                }
+                recv_buffer_.pop_cache(pack_size);
+                ++budget_packets;
+                budget_bytes += pack_size;
+            }
+            else if (result == parse_type::skip && pack_size > 0)
+            {
+                // 丢弃无法识别的数据 重新同步后继续解包
+                size_type skip_size = std::min(pack_size, recv_buffer_.size());
+                recv_buffer_.pop_cache(skip_size);
+                budget_bytes += skip_size;
+            }
+            else if (result == parse_type::less)
+            {
+                handle_receive_batch();
+                // 整理缓存 继续解包
+                recv_buffer_.move2head();
+                // 不足一包 继续接收
+                handle_recv();
+                break;
+            }
+            else /*(result == parse_type::bad || result == parse_type::indeterminate)*/
+            {
+                handle_receive_batch();
+                // 解包异常 停止
+                handle_stop(error_code::packet_error, "parse failed");
+                break;
+            }
+        }
+    }
+
+    bool budget_exhausted(const size_type& packets, const size_type& bytes)
+    {
+        if ((recv_budget_packets_ > 0 && packets >= recv_budget_packets_) || (recv_budget_bytes_ > 0 && bytes >= recv_budget_bytes_))
+        {
+            recv_budget_hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void handle_recv_yield()
+    {
+        recv_yields_.fetch_add(1, std::memory_order_relaxed);
+        auto self_ = std::dynamic_pointer_cast<self_type>(shared_from_this());
+        asio::post(socket_.get_executor(), [this, self_]() {
+            if (stopped())
+            {
+                // 让出期间连接已关闭 没有挂起的接收操作 在此结束
+                handle_stop(error_code::session_stopped, "session stopped");
+                return;
+            }
+            handle_parse();
+        });
+    }
+
+    void handle_receive_batch()
+    {
+        if (!recv_batch_.empty())
+        {
+            func_receive_batch_callback_(session_id(), recv_batch_.data(), recv_batch_.size());
+            recv_batch_.clear();
+        }
+    }
+
     void handle_send()
     {
-        lock_guard_type lk(mutex_);
+        session_lock_type lk(mutex_);
         if (stopped())
         {
             return;
         }
-        if (send_buff_ptr_ && !send_buff_ptr_->empty())
+        // 从发送队列取数据补充到发送批次 直到达到聚合上限
+        size_type batch_bytes = 0;
+        for (auto& buff : send_batch_)
+        {
+            batch_bytes += buff->size();
+        }
+        batch_bytes -= send_batch_offset_;
+        bool refilled = false;
+        buff_sptr_type buff;
+        while (send_batch_.size() < send_batch_count_ && batch_bytes < send_batch_bytes_ && pop_send_queue(buff))
         {
-            // 缓存数据未发完时继续发送
+            --send_queue_size_;
+            batch_bytes += buff->size();
+            send_batch_.emplace_back(std::move(buff));
+            refilled = true;
+        }
+        if (!send_batch_.empty())
+        {
+            // 设置发送超时
+            if (refilled && timer_wheel_)
+            {
+                last_send_tick_.store(timer_wheel_->now(), std::memory_order_relaxed);
+            }
+            else if (refilled && send_timeout_ > 0)
+            {
+                send_deadline_.expires_after(asio::chrono::seconds(send_timeout_));
+            }
             handle_async_send();
         }
         else
         {
-            // 缓存发送完则判断发送队列
-            if (send_queue_.empty())
+            // 无数据时标记空闲 由生产者入队后唤醒
+            // 标记后需再检查一次 防止与生产者入队交错时错过唤醒
+            send_idle_.store(true);
+            if (!send_queues_empty() && send_idle_.exchange(false))
             {
-                // 无数据时挂起等待数据
-                non_empty_send_queue_.expires_at(time_point_type::max());
-                non_empty_send_queue_.async_wait(std::bind(&socket_session<TSocket, TBuffer>::handle_send, std::dynamic_pointer_cast<socket_session<TSocket, TBuffer>>(shared_from_this())));
-                // 设置心跳定时器
-                if (heartbeat_interval_ > 0 && !heartbeat_data_.empty())
-                {
-                    heartbeat_timer_.expires_after(asio::chrono::seconds(heartbeat_interval_));
-                    heartbeat_timer_.async_wait(std::bind(&socket_session<TSocket, TBuffer>::check_heartbeat, std::dynamic_pointer_cast<socket_session<TSocket, TBuffer>>(shared_from_this())));
-                }
+                asio::post(socket_.get_executor(), std::bind(&self_type::handle_send, std::dynamic_pointer_cast<self_type>(shared_from_this())));
+                return;
             }
-            else
+            // 设置心跳定时器
+            if (!timer_wheel_ && heartbeat_interval_ > 0 && !heartbeat_data_.empty())
             {
-                // 设置发送超时
-                if (send_timeout_ > 0)
+                heartbeat_timer_.expires_after(asio::chrono::seconds(heartbeat_interval_));
+                heartbeat_timer_.async_wait(std::bind(&self_type::check_heartbeat, std::dynamic_pointer_cast<self_type>(shared_from_this())));
+            }
+        }
+    }
+
+    /**
+     * @brief 按调度方式从各优先级队列取一条消息
+     */
+    bool pop_send_queue(buff_sptr_type& buff)
+    {
+        if (send_schedule_ == schedule_strict)
+        {
+            for (size_type lane = 0; lane < priority_count; ++lane)
+            {
+                if (pop_send_lane(lane, buff))
                 {
-                    send_deadline_.expires_after(asio::chrono::seconds(send_timeout_));
+                    return true;
                 }
-                // 取队列数据并发送
-                send_buff_ptr_ = send_queue_.front();
-                send_queue_.pop();
-                handle_async_send();
             }
+            return false;
         }
+        // 按权重轮转 当前通道额度用完或为空时切换到下一通道, 最多轮转一圈
+        for (size_type i = 0; i <= priority_count; ++i)
+        {
+            if (send_lane_credit_ > 0 && pop_send_lane(send_lane_, buff))
+            {
+                --send_lane_credit_;
+                return true;
+            }
+            send_lane_ = (send_lane_ + 1) % priority_count;
+            send_lane_credit_ = send_weights_[send_lane_];
+        }
+        return false;
+    }
+
+    bool pop_send_lane(const size_type& lane, buff_sptr_type& buff)
+    {
+        return send_queues_[lane].pop(buff) || (lane == priority_bulk && send_conflation_.pop(buff));
+    }
+
+    bool send_queues_empty() const
+    {
+        for (auto& queue : send_queues_)
+        {
+            if (!queue.empty())
+            {
+                return false;
+            }
+        }
+        return send_conflation_.empty();
     }
 
     void handle_async_send()
     {
-        auto self_ = std::dynamic_pointer_cast<socket_session<TSocket, TBuffer>>(shared_from_this());
+        // 将发送批次组装为缓存序列 一次async_send(writev)发出
+        send_iovecs_.clear();
+        for (auto& buff : send_batch_)
+        {
+            send_iovecs_.emplace_back(buff->data(), buff->size());
+        }
+        send_iovecs_.front() += send_batch_offset_;
+
+        auto self_ = std::dynamic_pointer_cast<self_type>(shared_from_this());
         // 这里使用async_send是为了支持asio::ip::udp::socket，否则使用asio::async_write()可以保证一次性发完才响应代码更简洁
-        // TODO:后续可以看下asio的condition设置发送结束条件达到与asio::async_write()相同的效果，暂时先判断缓存buffer剩余数据
-        socket_.async_send(asio::buffer(send_buff_ptr_->data(), send_buff_ptr_->size()), [this, self_](std::error_code ec, std::size_t bytes_transferred) {
+        // 部分发送时按已发送长度跨消息推进 剩余数据在handle_send中继续发送
+        socket_.async_send(send_iovecs_, [this, self_](std::error_code ec, std::size_t bytes_transferred) {
             if (!ec)
             {
+                size_type drained = 0;
                 {
-                    lock_guard_type lk(mutex_);
-                    if (send_buff_ptr_)
+                    session_lock_type lk(mutex_);
+                    while (bytes_transferred > 0 && !send_batch_.empty())
                     {
-                        send_buff_ptr_->pop_cache(bytes_transferred);
+                        size_type remain = send_batch_.front()->size() - send_batch_offset_;
+                        if (bytes_transferred >= remain)
+                        {
+                            bytes_transferred -= remain;
+                            drained += send_batch_.front()->size();
+                            send_batch_.pop_front();
+                            send_batch_offset_ = 0;
+                        }
+                        else
+                        {
+                            send_batch_offset_ += bytes_transferred;
+                            bytes_transferred = 0;
+                        }
                     }
                 }
+                // 整条消息发完后才释放占用的字节数 回调在锁外执行
+                if (drained > 0)
+                {
+                    handle_drained(drained);
+                }
                 // 继续检测 发送
                 handle_send();
             }
@@ -385,9 +1191,46 @@ private:
         });
     }
 
+    /**
+     * @brief 生产者入队后调用, 发送链空闲时才投递唤醒, 发送中的数据由发送链自行取出
+     */
+    void wake_writer()
+    {
+        if (send_idle_.load() && send_idle_.exchange(false))
+        {
+            asio::post(socket_.get_executor(), std::bind(&self_type::handle_send, std::dynamic_pointer_cast<self_type>(shared_from_this())));
+        }
+    }
+
+    void handle_congested(const size_type& queued)
+    {
+        if (send_congested_.exchange(true))
+        {
+            return;
+        }
+        if (func_congested_callback_)
+        {
+            func_congested_callback_(session_id(), queued);
+        }
+        // 标记前发送链可能已回落到低水位 再检查一次 防止错过可写通知
+        handle_drained(0);
+    }
+
+    void handle_drained(const size_type& drained)
+    {
+        size_type queued = send_queue_bytes_.fetch_sub(drained) - drained;
+        if (send_congested_.load() && queued <= send_low_watermark_ && send_congested_.exchange(false))
+        {
+            if (func_writable_callback_)
+            {
+                func_writable_callback_(session_id(), queued);
+            }
+        }
+    }
+
     void check_deadline(timer_type &deadline)
     {
-        lock_guard_type lk(mutex_);
+        session_lock_type lk(mutex_);
         if (stopped())
         {
             return;
@@ -395,6 +1238,7 @@ private:
         if (deadline.expiry() <= timer_type::clock_type::now())
         {
             // 超时 不调用handle_stop() 关闭socket由接收发送响应来调用关闭
+            closed_.store(true, std::memory_order_release);
             if (socket_.is_open())
             {
                 boost::system::error_code ec;
@@ -404,8 +1248,132 @@ private:
         else
         {
             // 挂起 继续
-            deadline.async_wait(std::bind(&socket_session<TSocket, TBuffer>::check_deadline, std::dynamic_pointer_cast<socket_session<TSocket, TBuffer>>(shared_from_this()), std::ref(deadline)));
+            deadline.async_wait(std::bind(&self_type::check_deadline, std::dynamic_pointer_cast<self_type>(shared_from_this()), std::ref(deadline)));
+        }
+    }
+
+    void check_idle_shrink(const std::error_code& ec)
+    {
+        if (ec)
+        {
+            return;
+        }
+        handle_idle_shrink();
+        session_lock_type lk(mutex_);
+        if (!stopped())
+        {
+            recv_idle_timer_.expires_after(asio::chrono::seconds(recv_idle_shrink_));
+            recv_idle_timer_.async_wait(std::bind(&self_type::check_idle_shrink, std::dynamic_pointer_cast<self_type>(shared_from_this()), std::placeholders::_1));
+        }
+    }
+
+    /**
+     * @brief 按上个周期内最高水位收缩接收缓存, 仅在等待可读(缓存未被接收操作占用)时进行
+     */
+    void handle_idle_shrink()
+    {
+        session_lock_type lk(mutex_);
+        if (!stopped() && recv_waiting_)
+        {
+            recv_buffer_.trim();
+        }
+    }
+
+    void handle_wheel_start()
+    {
+        // 时间轮持有会话弱引用 会话释放后自动移除
+        std::weak_ptr<void> owner = shared_from_this();
+        tick_type now = timer_wheel_->now();
+        last_recv_tick_.store(now, std::memory_order_relaxed);
+        last_send_tick_.store(now, std::memory_order_relaxed);
+        if (recv_timeout_ > 0)
+        {
+            tick_type timeout = timer_wheel_->to_ticks(asio::chrono::seconds(recv_timeout_));
+            timer_wheel_->schedule(owner, timeout, std::bind(&self_type::check_wheel_deadline, this, std::ref(last_recv_tick_), timeout, std::placeholders::_1));
+        }
+        if (send_timeout_ > 0)
+        {
+            tick_type timeout = timer_wheel_->to_ticks(asio::chrono::seconds(send_timeout_));
+            timer_wheel_->schedule(owner, timeout, std::bind(&self_type::check_wheel_deadline, this, std::ref(last_send_tick_), timeout, std::placeholders::_1));
+        }
+        if (recv_idle_shrink_ > 0)
+        {
+            tick_type period = timer_wheel_->to_ticks(asio::chrono::seconds(recv_idle_shrink_));
+            timer_wheel_->schedule(owner, period, std::bind(&self_type::check_wheel_idle_shrink, this, period, std::placeholders::_1));
+        }
+        if (heartbeat_interval_ > 0 && !heartbeat_data_.empty())
+        {
+            heartbeat_ticks_ = timer_wheel_->to_ticks(asio::chrono::seconds(heartbeat_interval_));
+            heartbeat_buff_ = make_send_buffer(heartbeat_data_.c_str(), heartbeat_data_.length());
+            if (heartbeat_service_)
+            {
+                heartbeat_service_->add(std::dynamic_pointer_cast<self_type>(shared_from_this()));
+            }
+            else
+            {
+                timer_wheel_->schedule(owner, heartbeat_ticks_, std::bind(&self_type::check_wheel_heartbeat, this, std::placeholders::_1));
+            }
+        }
+    }
+
+    /**
+     * @brief 时间轮超时检查(时间轮strand), 未超时返回剩余tick数继续挂起
+     */
+    tick_type check_wheel_deadline(const std::atomic<tick_type>& last_tick, const tick_type& timeout, const tick_type& now)
+    {
+        if (stopped())
+        {
+            return 0;
+        }
+        tick_type last = last_tick.load(std::memory_order_relaxed);
+        tick_type elapsed = now > last ? now - last : 0;
+        if (elapsed >= timeout)
+        {
+            // 超时 关闭socket由接收发送响应来调用关闭
+            stop();
+            return 0;
+        }
+        return timeout - elapsed;
+    }
+
+    tick_type check_wheel_idle_shrink(const tick_type& period, const tick_type& now)
+    {
+        if (stopped())
+        {
+            return 0;
+        }
+        // 接收缓存只能在会话的执行器上修改
+        asio::post(socket_.get_executor(), std::bind(&self_type::handle_idle_shrink, std::dynamic_pointer_cast<self_type>(shared_from_this())));
+        return period;
+    }
+
+    tick_type check_wheel_heartbeat(const tick_type& now)
+    {
+        if (stopped())
+        {
+            return 0;
+        }
+        return handle_idle_heartbeat(now);
+    }
+
+    /**
+     * @brief 链路空闲时发送心跳
+     * @return 距下次需要检查的tick数
+     */
+    tick_type handle_idle_heartbeat(const tick_type& now)
+    {
+        tick_type last = last_send_tick_.load(std::memory_order_relaxed);
+        tick_type elapsed = now > last ? now - last : 0;
+        if (elapsed < heartbeat_ticks_)
+        {
+            return heartbeat_ticks_ - elapsed;
+        }
+        // 超过心跳间隔未发送且发送链空闲 发送心跳; 发送链忙说明仍有数据在发 无需心跳
+        if (send_idle_.load(std::memory_order_relaxed))
+        {
+            async_send(heartbeat_buff_, priority_urgent);
         }
+        return heartbeat_ticks_;
     }
 
     void check_heartbeat()
@@ -417,7 +1385,7 @@ private:
         if (heartbeat_timer_.expiry() <= timer_type::clock_type::now())
         {
             // 超时 发送心跳
-            async_send(heartbeat_data_.c_str(), heartbeat_data_.length());
+            async_send(heartbeat_data_.c_str(), heartbeat_data_.length(), priority_urgent);
         }
     }
 };
@@ -426,6 +1394,11 @@ private:
 // TCP
 using tcp_socket = asio::ip::tcp::socket;
 using tcp_session = socket_session<tcp_socket, buffer>;
+// 解包方法签名为(const ring_buffer&), 见socket_session::func_pack_parse_type
+using tcp_ring_session = socket_session<tcp_socket, ring_buffer>;
+template<class TPolicy>
+using tcp_policy_session = socket_session<tcp_socket, buffer, TPolicy>;
+using tcp_strand_session = socket_session<tcp_socket, buffer, function_policy<buffer>, strand_execution>;
 // UDP
 using udp_socket = asio::ip::udp::socket;
 using udp_session = socket_session<udp_socket, buffer>;
@@ -0,0 +1,132 @@
+#ifndef DY_NET_SESSION_GROUP_H
+#define DY_NET_SESSION_GROUP_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "net/session.h"
+
+namespace dy
+{
+namespace utility
+{
+/**
+ * @brief 会话组, 将同一份数据广播给组内所有会话
+ * 数据只构造一次, 各会话共享引用并独立记录发送进度
+ * 广播遍历组成员快照, 不持有组锁, 发送回调(如拥塞回调)中可直接增删成员
+ */
+template<typename TSession>
+class session_group
+{
+public:
+    using session_type = TSession;
+    using sessionid_type = typename session_type::sessionid_type;
+    using session_ptr_type = std::shared_ptr<session_type>;
+    using buff_sptr_type = typename session_type::buff_sptr_type;
+    using mutex_type = typename session_type::mutex_type;
+    using lock_guard_type = typename session_type::lock_guard_type;
+    using size_type = typename session_type::size_type;
+    using map_type = std::unordered_map<sessionid_type, session_ptr_type>;
+    using snapshot_type = std::shared_ptr<const std::vector<session_ptr_type>>;
+
+private:
+    mutex_type mutex_;
+    map_type sessions_;
+    snapshot_type snapshot_;    // 成员快照 成员变化后在下次广播时重建
+
+public:
+    DISABLE_COPY_ASSIGN(session_group);
+    session_group() = default;
+
+    int add(const session_ptr_type& session_ptr)
+    {
+        if (!session_ptr)
+        {
+            return error_code::normal_error;
+        }
+        lock_guard_type lk(mutex_);
+        sessions_[session_ptr->session_id()] = session_ptr;
+        snapshot_.reset();
+        return error_code::ok;
+    }
+
+    int remove(const sessionid_type& session_id)
+    {
+        lock_guard_type lk(mutex_);
+        if (sessions_.erase(session_id) == 0)
+        {
+            return error_code::session_not_exist;
+        }
+        snapshot_.reset();
+        return error_code::ok;
+    }
+
+    size_type size()
+    {
+        lock_guard_type lk(mutex_);
+        return sessions_.size();
+    }
+
+    void clear()
+    {
+        lock_guard_type lk(mutex_);
+        sessions_.clear();
+        snapshot_.reset();
+    }
+
+    /**
+     * @brief 广播共享数据
+     * @return 成功投递的会话数
+     */
+    size_type broadcast(const buff_sptr_type& payload, const size_type& priority = session_type::priority_normal)
+    {
+        size_type count = 0;
+        for (auto& item : *snapshot())
+        {
+            if (item->async_send(payload, priority) == error_code::ok)
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief 拷贝一次数据后广播
+     * @return 成功投递的会话数
+     */
+    size_type broadcast(const char* data, const buffer::size_type& length, const size_type& priority = session_type::priority_normal)
+    {
+        if (!data || length == 0)
+        {
+            return 0;
+        }
+        return broadcast(make_send_buffer(data, length), priority);
+    }
+
+private:
+    snapshot_type snapshot()
+    {
+        lock_guard_type lk(mutex_);
+        if (!snapshot_)
+        {
+            auto sessions = std::make_shared<std::vector<session_ptr_type>>();
+            sessions->reserve(sessions_.size());
+            for (auto& item : sessions_)
+            {
+                sessions->emplace_back(item.second);
+            }
+            snapshot_ = std::move(sessions);
+        }
+        return snapshot_;
+    }
+};
+
+// explicit class declaration
+// TCP
+using tcp_session_group = session_group<tcp_session>;
+
+} // namespace utility
+} // namespace dy
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef DY_NET_TIMER_WHEEL_H
+#define DY_NET_TIMER_WHEEL_H
+
+#include <atomic>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <functional>
+
+#include "common/comm_def.h"
+
+#include <boost/asio.hpp>
+
+namespace dy
+{
+namespace utility
+{
+namespace asio = boost::asio;
+
+/**
+ * @brief 分层时间轮
+ * 每个io线程(io_context)一个实例, 一个定时器驱动所有注册项, 以tick为粒度
+ * 注册项采用惰性超时: 使用方只需记录最近活跃的tick(一次原子写), 到期时由回调计算剩余时间并重新挂入时间轮
+ * 定时器与槽位操作串行在时间轮自己的strand上, io_context可多线程运行, schedule()可在任意线程调用
+ */
+class timer_wheel : public std::enable_shared_from_this<timer_wheel>
+{
+public:
+    using tick_type = std::uint64_t;
+    using duration_type = asio::steady_timer::duration;
+    using executor_type = asio::strand<asio::io_context::executor_type>;
+    // 参数为当前tick 返回距下次触发的tick数 返回0表示移除
+    using handler_type = std::function<tick_type(const tick_type& /*now*/)>;
+
+    enum constant : tick_type
+    {
+        level_bits  = 8,
+        level_slots = 1 << level_bits,  // 每层槽位数
+        level_count = 4,                // 层数
+        level_mask  = level_slots - 1,
+    };
+
+private:
+    struct item
+    {
+        tick_type expiry_;              // 到期tick
+        std::weak_ptr<void> owner_;     // 注册方 释放后自动移除
+        handler_type handler_;
+    };
+    using slot_type = std::vector<item>;
+
+    executor_type executor_;
+    asio::steady_timer timer_;
+    duration_type tick_duration_;
+    asio::steady_timer::time_point origin_;
+    std::atomic<tick_type> now_{0};     // 当前tick
+    slot_type slots_[constant::level_count][constant::level_slots];
+
+public:
+    DISABLE_COPY_ASSIGN(timer_wheel);
+
+    explicit timer_wheel(asio::io_context& ioc, const duration_type& tick_duration = asio::chrono::milliseconds(100))
+        : executor_(asio::make_strand(ioc)), timer_(executor_), tick_duration_(tick_duration)
+    {
+    }
+
+    void start()
+    {
+        asio::dispatch(executor_, std::bind(&timer_wheel::handle_start, shared_from_this()));
+    }
+
+    void stop()
+    {
+        asio::dispatch(executor_, std::bind(&timer_wheel::handle_stop, shared_from_this()));
+    }
+
+    const executor_type& get_executor() const
+    {
+        return executor_;
+    }
+
+    /**
+     * @brief 当前tick, 供注册方记录活跃时间
+     */
+    tick_type now() const
+    {
+        return now_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 时长换算为tick数(向上取整 至少1)
+     */
+    tick_type to_ticks(const duration_type& duration) const
+    {
+        tick_type ticks = static_cast<tick_type>((duration + tick_duration_ - duration_type(1)) / tick_duration_);
+        return ticks > 0 ? ticks : 1;
+    }
+
+    /**
+     * @brief 注册定时回调, delay个tick后在时间轮strand上回调
+     * @param owner 注册方 释放后不再回调
+     */
+    void schedule(std::weak_ptr<void> owner, const tick_type& delay, handler_type handler)
+    {
+        auto self = shared_from_this();
+        auto owner_ptr = std::make_shared<std::weak_ptr<void>>(std::move(owner));
+        auto handler_ptr = std::make_shared<handler_type>(std::move(handler));
+        asio::dispatch(executor_, [self, owner_ptr, handler_ptr, delay]() {
+            self->insert(item{self->now() + (delay > 0 ? delay : 1), std::move(*owner_ptr), std::move(*handler_ptr)});
+        });
+    }
+
+private:
+    void handle_start()
+    {
+        origin_ = asio::steady_timer::clock_type::now();
+        timer_.expires_at(origin_ + tick_duration_);
+        timer_.async_wait(std::bind(&timer_wheel::handle_tick, shared_from_this(), std::placeholders::_1));
+    }
+
+    void handle_stop()
+    {
+        timer_.cancel();
+        for (auto& level : slots_)
+        {
+            for (auto& slot : level)
+            {
+                slot.clear();
+            }
+        }
+    }
+
+    void handle_tick(const boost::system::error_code& ec)
+    {
+        if (ec)
+        {
+            return;
+        }
+        // 按实际经过的时间追赶 避免回调耗时造成累积误差
+        auto now = asio::steady_timer::clock_type::now();
+        tick_type target = static_cast<tick_type>((now - origin_) / tick_duration_);
+        while (now_.load(std::memory_order_relaxed) < target)
+        {
+            advance();
+        }
+        timer_.expires_at(origin_ + tick_duration_ * (target + 1));
+        timer_.async_wait(std::bind(&timer_wheel::handle_tick, shared_from_this(), std::placeholders::_1));
+    }
+
+    void advance()
+    {
+        tick_type tick = now_.load(std::memory_order_relaxed) + 1;
+        now_.store(tick, std::memory_order_relaxed);
+        // 低层转满一圈时将上层对应槽位下放
+        for (tick_type level = 1; level < constant::level_count; ++level)
+        {
+            if (((tick >> ((level - 1) * constant::level_bits)) & constant::level_mask) != 0)
+            {
+                break;
+            }
+            cascade(level, (tick >> (level * constant::level_bits)) & constant::level_mask);
+        }
+        // 执行当前槽位
+        slot_type expired;
+        expired.swap(slots_[0][tick & constant::level_mask]);
+        for (auto& entry : expired)
+        {
+            auto owner = entry.owner_.lock();
+            if (!owner)
+            {
+                continue;
+            }
+            tick_type delay = entry.handler_(tick);
+            if (delay > 0)
+            {
+                entry.expiry_ = tick + delay;
+                insert(std::move(entry));
+            }
+        }
+    }
+
+    void cascade(const tick_type& level, const tick_type& index)
+    {
+        slot_type items;
+        items.swap(slots_[level][index]);
+        for (auto& entry : items)
+        {
+            insert(std::move(entry));
+        }
+    }
+
+    void insert(item&& entry)
+    {
+        tick_type now = now_.load(std::memory_order_relaxed);
+        // 下放时到期的项放入当前槽位 随后即被执行
+        if (entry.expiry_ < now)
+        {
+            entry.expiry_ = now;
+        }
+        tick_type delta = entry.expiry_ - now;
+        for (tick_type level = 0; level < constant::level_count; ++level)
+        {
+            if (delta < (tick_type(1) << ((level + 1) * constant::level_bits)) || level + 1 == constant::level_count)
+            {
+                // 超出最大范围的放在最高层 下放时重新计算
+                tick_type expiry = std::min(entry.expiry_, now + (tick_type(1) << (constant::level_count * constant::level_bits)) - 1);
+                slots_[level][(expiry >> (level * constant::level_bits)) & constant::level_mask].emplace_back(std::move(entry));
+                return;
+            }
+        }
+    }
+};
+
+} // namespace utility
+} // namespace dy
+
+#endif
@@ -0,0 +1,131 @@
+// 组播接收回环测试: 同一端口不同组的接收互不混入, 序号缺口与重复计数正确, 4字节序号回绕与源重启后重新同步
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "net/multicast_receiver.h"
+
+using namespace dy::utility;
+
+namespace
+{
+const unsigned short test_port = 47321;
+const char* loopback = "127.0.0.1";
+
+int failures = 0;
+
+void expect(const bool& condition, const char* message)
+{
+    if (!condition)
+    {
+        ++failures;
+        std::cerr << "FAILED: " << message << std::endl;
+    }
+}
+
+void send_sequence(asio::ip::udp::socket& sender, const char* group, const std::uint32_t& sequence)
+{
+    std::uint32_t value = __builtin_bswap32(sequence);
+    sender.send_to(asio::buffer(&value, sizeof(value)), asio::ip::udp::endpoint(asio::ip::make_address(group), test_port));
+}
+} // namespace
+
+int main()
+{
+    asio::io_context ioc;
+    std::vector<std::uint32_t> received_a;
+    std::size_t received_b = 0;
+    auto receiver_a = std::make_shared<multicast_receiver>(ioc,
+        [&](const session::sessionid_type&, const datagram* datagrams, const session::size_type& count) {
+            for (session::size_type i = 0; i < count; ++i)
+            {
+                std::uint32_t value;
+                memcpy(&value, datagrams[i].data, sizeof(value));
+                received_a.push_back(__builtin_bswap32(value));
+            }
+        },
+        nullptr,
+        [](const session::sessionid_type&, const int&, const std::string&) {});
+    auto receiver_b = std::make_shared<multicast_receiver>(ioc,
+        [&](const session::sessionid_type&, const datagram*, const session::size_type& count) {
+            received_b += count;
+        },
+        nullptr,
+        [](const session::sessionid_type&, const int&, const std::string&) {});
+    std::vector<std::uint32_t> received_c;
+    std::vector<std::uint32_t> resynced_c;
+    auto receiver_c = std::make_shared<multicast_receiver>(ioc,
+        [&](const session::sessionid_type&, const datagram* datagrams, const session::size_type& count) {
+            for (session::size_type i = 0; i < count; ++i)
+            {
+                std::uint32_t value;
+                memcpy(&value, datagrams[i].data, sizeof(value));
+                received_c.push_back(__builtin_bswap32(value));
+            }
+        },
+        [&](const session::sessionid_type&, const multicast_receiver::sequence_type& expected, const multicast_receiver::sequence_type& received) {
+            if (received < expected)
+            {
+                resynced_c.push_back(static_cast<std::uint32_t>(received));
+            }
+        },
+        [](const session::sessionid_type&, const int&, const std::string&) {});
+
+    if (receiver_a->join("239.1.1.1", test_port, loopback) != error_code::ok ||
+        receiver_b->join("239.1.1.2", test_port, loopback) != error_code::ok ||
+        receiver_c->join("239.1.1.3", test_port, loopback) != error_code::ok)
+    {
+        // 环境不支持组播时跳过
+        std::cout << "multicast unavailable, skipped" << std::endl;
+        return 0;
+    }
+    receiver_a->start();
+    receiver_b->start();
+    receiver_c->start();
+    std::thread io([&ioc]() { ioc.run(); });
+
+    asio::ip::udp::socket sender(ioc);
+    sender.open(asio::ip::udp::v4());
+    sender.set_option(asio::ip::multicast::outbound_interface(asio::ip::make_address_v4(loopback)));
+    sender.set_option(asio::ip::multicast::enable_loopback(true));
+    // 1 2 3 [缺4 5] 6 6(重复) 3(迟到) 7
+    for (std::uint32_t sequence : {1u, 2u, 3u, 6u, 6u, 3u, 7u})
+    {
+        send_sequence(sender, "239.1.1.1", sequence);
+    }
+    // 回绕 0xFFFFFFFE 0xFFFFFFFF 0 1 0(重复) [缺2..299999] 300000 300001, 然后源重启 从5开始
+    for (std::uint32_t sequence : {0xFFFFFFFEu, 0xFFFFFFFFu, 0u, 1u, 0u, 300000u, 300001u, 5u, 6u})
+    {
+        send_sequence(sender, "239.1.1.3", sequence);
+    }
+    // 等待全部到达 超时后按实际结果判断
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((receiver_a->get_statistics().received_ < 7 || receiver_c->get_statistics().received_ < 9)
+           && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    receiver_a->stop();
+    receiver_b->stop();
+    receiver_c->stop();
+    ioc.stop();
+    io.join();
+
+    auto stats = receiver_a->get_statistics();
+    expect(received_a == std::vector<std::uint32_t>({1, 2, 3, 6, 7}), "in-order delivery");
+    expect(stats.received_ == 7, "received count");
+    expect(stats.duplicates_ == 2, "duplicate count");
+    expect(stats.gaps_ == 1 && stats.lost_ == 2, "gap detection");
+    expect(received_b == 0, "other group on the same port is isolated");
+
+    auto stats_c = receiver_c->get_statistics();
+    expect(received_c == std::vector<std::uint32_t>({0xFFFFFFFEu, 0xFFFFFFFFu, 0, 1, 300000, 300001, 5, 6}), "4-byte wrap and resync delivery");
+    expect(stats_c.duplicates_ == 1 && stats_c.gaps_ == 1 && stats_c.lost_ == 299998, "4-byte wrap is not a gap");
+    expect(stats_c.resets_ == 1 && resynced_c == std::vector<std::uint32_t>({5}), "large backward jump resynchronizes");
+
+    std::cout << (failures == 0 ? "passed" : "failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}